@@ -4,7 +4,6 @@
 #include <tools/BindCachingMixin.hpp>
 
 #include <limits>
-#include <algorithm>
 #include <string>
 
 static class ChunksApplicationClass : public TclClass {
@@ -28,32 +27,39 @@ private:
     ChunksApplication * app_;
 };
 
-struct ChunksApplication::Chunk { 
-    double time;
-    int size_in_bytes; 
-
-    auto operator<(Chunk const& other) {
-        return make_tuple(time, size_in_bytes) 
-            < make_tuple(other.time, other.size_in_bytes);
-    };
-};
-
-
 ChunksApplication::ChunksApplication() : 
-    next_chunk_timer_{make_unique<NextChunkTimer>(this)} {
+    next_chunk_timer_{make_unique<NextChunkTimer>(this)},
+    flow_start_time_{0},
+    ideal_transfer_time_{0} {
 
 }
 
 void ChunksApplication::send(int nbytes) {
+    flow_start_time_ = Scheduler::instance().clock();
     agent_->sendmsg(0, "DAT_NEW");
     if (check_if_using_alpha()) {
         init_chunks(nbytes);
         send_next_chunk();
     } else {
+        ideal_transfer_time_ = nbytes / packet_size_bytes_ * packet_time();
         agent_->sendmsg(nbytes, "DAT_EOF");
     }
 }
 
+void ChunksApplication::send_chunks(std::vector<Chunk> const& chunks) {
+    flow_start_time_ = Scheduler::instance().clock();
+    agent_->sendmsg(0, "DAT_NEW");
+    schedule_.replay(begin(chunks), end(chunks), flow_start_time_,
+            packet_size_bytes_, packet_time());
+    next_chunk_ = schedule_.next();
+    send_next_chunk();
+}
+
+auto ChunksApplication::packet_time() const -> double {
+    return (packet_size_bytes_ + header_size_bytes_)
+        * BITS_IN_BYTE / (link_rate_gbps_ * 1e9);
+}
+
 auto ChunksApplication::check_if_using_alpha() -> bool {
     if (use_alpha_probability_ < 0) {
         return true;
@@ -70,6 +76,7 @@ void ChunksApplication::delay_bind_init_all() {
     delay_bind_init_one("header_size_bytes_");
     delay_bind_init_one("max_num_chunks_");
     delay_bind_init_one("use_alpha_probability_");
+    delay_bind_init_one("streaming_schedule_");
 }
 
 int ChunksApplication::command(int argc, const char * const * argv) {
@@ -87,74 +94,38 @@ auto ChunksApplication::get_random_device() const -> RNG& {
     return *rng_;
 }
 
-auto ChunksApplication::generate_chunks(double start_time, int num_bytes) const
-        -> std::vector<Chunk> {
+void ChunksApplication::init_chunks(int num_bytes) {
     auto const num_packets = num_bytes / packet_size_bytes_;
-    auto const packet_time =  (packet_size_bytes_ + header_size_bytes_)
-        * BITS_IN_BYTE / (link_rate_gbps_ * 1e9);
-
-    auto const num_chunks = std::min(num_packets, max_num_chunks_);
-    auto const chunk_size_pkts = num_packets / num_chunks;
-    auto const num_bigger_chunks = num_packets % num_chunks;
-
-    auto chunks = std::vector<Chunk>(num_chunks);
-    auto total_size = 0;
-    for (auto i = 0; i < num_chunks; i++) {
-        chunks[i] = Chunk { 
-            .time = get_next_random_double(
-                        start_time, 
-                        start_time + alpha_ * packet_time * num_packets
-                    ),
-            .size_in_bytes = packet_size_bytes_ * 
-                (i < num_bigger_chunks ? chunk_size_pkts + 1 : chunk_size_pkts)
-        };
-        if (chunks[i].size_in_bytes <= 0) {
-            throw std::logic_error("Empty chunk!");
-        }
-        total_size += chunks[i].size_in_bytes;
-    }
-    if (total_size != num_bytes) {
+    if (num_packets * packet_size_bytes_ != num_bytes) {
         throw std::logic_error("Generated chunks have a different number of bytes");
     }
 
-    std::sort(begin(chunks), end(chunks));
+    auto const start_time = flow_start_time_;
 
-    return chunks;
-}
-
-void ChunksApplication::init_chunks(int num_bytes) {
-    cur_chunks_ = generate_chunks(Scheduler::instance().clock(), num_bytes);
-    next_chunk_idx_ = 0;
+    schedule_.reset(
+            streaming_schedule_ ? Schedule::Mode::STREAMING : Schedule::Mode::LEGACY,
+            get_random_device(),
+            start_time,
+            start_time + alpha_ * packet_time() * num_packets,
+            num_packets, max_num_chunks_, packet_size_bytes_, packet_time());
+    next_chunk_ = schedule_.next();
 }
 
 void ChunksApplication::send_next_chunk() {
     agent_->sendmsg(
-            get_next_chunk().size_in_bytes,
-            next_chunk_idx_ + 1 == cur_chunks_.size() ? 
-                "DAT_EOF" : nullptr
+            next_chunk_.size_in_bytes,
+            schedule_.done() ? "DAT_EOF" : nullptr
             );
 
-    next_chunk_idx_++;
-
-    if (next_chunk_idx_ < cur_chunks_.size()) {
+    if (!schedule_.done()) {
+        next_chunk_ = schedule_.next();
         next_chunk_timer_->resched(
-                get_next_chunk().time- Scheduler::instance().clock());
-
+                next_chunk_.time - Scheduler::instance().clock());
+    } else {
+        ideal_transfer_time_ = schedule_.ideal_finish_time() - flow_start_time_;
     }
 }
 
-auto ChunksApplication::get_next_chunk() const -> Chunk const& {
-    return cur_chunks_[next_chunk_idx_];
-}
-
-auto ChunksApplication::get_next_random_double(double min, double max) const 
-        -> double {
-    auto const x = std::generate_canonical<
-            double, std::numeric_limits<double>::digits
-        >(get_random_device());
-    return min + x * (max - min);
-}
-
 int ChunksApplication::delay_bind_dispatch(
         const char *varName, const char *localName, TclObject *tracer
         ) {
@@ -164,6 +135,7 @@ int ChunksApplication::delay_bind_dispatch(
     if (delay_bind(varName, localName, "header_size_bytes_", &header_size_bytes_, tracer)) return TCL_OK;
     if (delay_bind(varName, localName, "max_num_chunks_", &max_num_chunks_, tracer)) return TCL_OK;
     if (delay_bind(varName, localName, "use_alpha_probability_", &use_alpha_probability_, tracer)) return TCL_OK;
+    if (delay_bind_bool(varName, localName, "streaming_schedule_", &streaming_schedule_, tracer)) return TCL_OK;
 
     return super::delay_bind_dispatch(varName, localName, tracer);
 }
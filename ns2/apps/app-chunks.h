@@ -3,6 +3,7 @@
 
 #include "app.h"
 #include "timer-handler.h"
+#include "chunk-schedule.h"
 #include <tools/BindCachingMixin.h>
 #include <random>
 #include <optional>
@@ -10,11 +11,27 @@
 class ChunksApplication : public BindCachingMixin<Application> {
     using super = BindCachingMixin;
     using RNG = std::minstd_rand0;
+    using Schedule = ChunkSchedule<RNG>;
 public:
+    using Chunk = Schedule::Chunk;
+
     ChunksApplication();
 
     void send(int nbytes) override;
 
+    /*
+     * Sends a flow released as the given chunks (times relative to now)
+     * instead of drawing the schedule.
+     */
+    void send_chunks(std::vector<Chunk> const& chunks);
+
+    /*
+     * Time the current flow would take at line rate, with every chunk
+     * sent as soon as it is released.  Valid once the last chunk has
+     * been handed to the agent.
+     */
+    [[nodiscard]] auto ideal_transfer_time() const -> double { return ideal_transfer_time_; }
+
     int command(int argc, const char * const * argv) override;
 
     void delay_bind_init_all() override;
@@ -27,26 +44,26 @@ private:
     static auto const BITS_IN_BYTE = 8;
 
 private:
-    struct Chunk;
     class NextChunkTimer;
 
 private:
-    auto get_next_chunk() const -> Chunk const&;
     auto check_if_using_alpha() -> bool;
-    auto generate_chunks(double start_time, int num_bytes) const
-        -> std::vector<Chunk>;
+    auto packet_time() const -> double;
 
     void init_chunks(int num_bytes);
     void send_next_chunk();
 
     auto get_random_device() const -> RNG&;
-    auto get_next_random_double(double min, double max) const -> double;
 
 private:
     std::unique_ptr<RNG> rng_;
     std::unique_ptr<NextChunkTimer> next_chunk_timer_;
-    std::vector<Chunk> cur_chunks_;
-    size_t next_chunk_idx_;
+    Schedule schedule_;
+    Schedule::Chunk next_chunk_;
+    double flow_start_time_;
+    double ideal_transfer_time_;
+
+    int streaming_schedule_;    // bool: Schedule::Mode::STREAMING
 
     double use_alpha_probability_;
     double alpha_;
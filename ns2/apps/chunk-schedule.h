@@ -0,0 +1,185 @@
+#ifndef ns_chunk_schedule_h
+#define ns_chunk_schedule_h
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+/*
+ * Release times of the chunks of one flow: the flow's packets are split
+ * into min(packets, max_num_chunks) chunks of (almost) equal size, each
+ * released at an independent uniform time in [start, end).
+ *
+ * Self-contained, so the offline oracle FCT tool
+ * (scripts/plot_generation/append_true_fct.cpp) generates exactly the
+ * schedules ChunksApplication used from the same seeds.
+ *
+ * LEGACY reproduces the original RNG sequence: one uniform per chunk in
+ * chunk order, the larger chunks first, then sorted by time.  It needs
+ * the whole schedule at once; the buffer is kept between flows so only
+ * the largest flow allocates.
+ *
+ * STREAMING yields the chunks in time order without storing them.  The
+ * next of the m remaining order statistics above u is
+ * u + (1 - u) (1 - V^(1/m)) for V uniform, and a chunk is one of the
+ * larger ones with probability (larger left) / (chunks left), so every
+ * chunk costs O(1) time and the flow O(1) memory.  The schedules have
+ * the same distribution as LEGACY but use the RNG differently.
+ *
+ * replay() instead takes a given schedule (a replayed trace); it is
+ * sorted into the LEGACY buffer and returned like a LEGACY one.
+ *
+ * Either way the schedule also tracks when a sender transmitting every
+ * chunk at line rate as soon as it is released would finish: the oracle
+ * (ideal) completion time used to normalise FCTs.
+ */
+template<class RNG>
+class ChunkSchedule {
+public:
+    enum class Mode { LEGACY, STREAMING };
+
+    struct Chunk {
+        double time;
+        int size_in_bytes;
+
+        auto operator<(Chunk const& other) const -> bool {
+            return std::make_tuple(time, size_in_bytes)
+                < std::make_tuple(other.time, other.size_in_bytes);
+        }
+    };
+
+    ChunkSchedule() = default;
+
+    /*
+     * Starts the schedule of a flow of num_packets packets, each taking
+     * packet_time at line rate.  Throws std::logic_error for an empty
+     * flow.
+     */
+    void reset(Mode mode, RNG& rng, double start_time, double end_time,
+            int num_packets, int max_num_chunks, int packet_size_bytes,
+            double packet_time) {
+        if (num_packets <= 0 || max_num_chunks <= 0) {
+            throw std::logic_error("Empty chunk!");
+        }
+
+        mode_ = mode;
+        rng_ = &rng;
+        start_time_ = start_time;
+        span_ = end_time - start_time;
+        packet_size_bytes_ = packet_size_bytes;
+        packet_time_ = packet_time;
+        ideal_finish_time_ = start_time;
+
+        auto const num_chunks = std::min(num_packets, max_num_chunks);
+        chunk_size_pkts_ = num_packets / num_chunks;
+        chunks_left_ = num_chunks;
+        bigger_left_ = num_packets % num_chunks;
+        position_ = 0;
+
+        if (mode_ == Mode::LEGACY) {
+            fill_sorted(num_chunks);
+        }
+    }
+
+    /*
+     * Starts a flow with the given chunks, whose times are relative to
+     * start_time.  Throws std::logic_error for an empty flow.
+     */
+    template<class It>
+    void replay(It first, It last, double start_time, int packet_size_bytes,
+            double packet_time) {
+        if (first == last) {
+            throw std::logic_error("Empty chunk!");
+        }
+
+        mode_ = Mode::LEGACY;
+        packet_size_bytes_ = packet_size_bytes;
+        packet_time_ = packet_time;
+        ideal_finish_time_ = start_time;
+
+        sorted_.clear();
+        for (; first != last; ++first) {
+            sorted_.push_back(Chunk{start_time + first->time, first->size_in_bytes});
+        }
+        std::sort(begin(sorted_), end(sorted_));
+        chunks_left_ = static_cast<int>(sorted_.size());
+    }
+
+    [[nodiscard]] auto done() const -> bool { return chunks_left_ == 0; }
+    [[nodiscard]] auto chunks_left() const -> int { return chunks_left_; }
+
+    /*
+     * Ideal completion time of the chunks returned so far, i.e. of the
+     * flow once done().
+     */
+    [[nodiscard]] auto ideal_finish_time() const -> double { return ideal_finish_time_; }
+
+    /*
+     * The next chunk in time order; only valid while !done().
+     */
+    auto next() -> Chunk {
+        auto const chunk = next_chunk();
+        ideal_finish_time_ = std::max(chunk.time, ideal_finish_time_)
+            + chunk.size_in_bytes / packet_size_bytes_ * packet_time_;
+        return chunk;
+    }
+
+private:
+    auto next_chunk() -> Chunk {
+        --chunks_left_;
+        if (mode_ == Mode::LEGACY) {
+            return sorted_[sorted_.size() - chunks_left_ - 1];
+        }
+
+        auto const m = chunks_left_ + 1;
+        auto const v = 1 - uniform();      // (0, 1]
+        position_ += (1 - position_) * -std::expm1(std::log(v) / m);
+
+        auto const bigger = bigger_left_ > 0
+            && uniform() * m < bigger_left_;
+        if (bigger) {
+            --bigger_left_;
+        }
+        return Chunk{
+            start_time_ + position_ * span_,
+            packet_size_bytes_ * (bigger ? chunk_size_pkts_ + 1 : chunk_size_pkts_)
+        };
+    }
+
+    auto uniform() -> double {
+        return std::generate_canonical<
+            double, std::numeric_limits<double>::digits>(*rng_);
+    }
+
+    void fill_sorted(int num_chunks) {
+        sorted_.resize(num_chunks);
+        for (auto i = 0; i < num_chunks; i++) {
+            sorted_[i] = Chunk{
+                start_time_ + uniform() * span_,
+                packet_size_bytes_ *
+                    (i < bigger_left_ ? chunk_size_pkts_ + 1 : chunk_size_pkts_)
+            };
+        }
+        std::sort(begin(sorted_), end(sorted_));
+    }
+
+private:
+    Mode mode_ = Mode::LEGACY;
+    RNG* rng_ = nullptr;
+    double start_time_ = 0;
+    double span_ = 0;
+    int packet_size_bytes_ = 0;
+    double packet_time_ = 0;
+    double ideal_finish_time_ = 0;
+    int chunk_size_pkts_ = 0;
+    int chunks_left_ = 0;
+    int bigger_left_ = 0;
+    double position_ = 0;       // STREAMING: last order statistic in [0, 1)
+    std::vector<Chunk> sorted_; // LEGACY
+};
+
+#endif
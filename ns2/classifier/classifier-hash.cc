@@ -134,6 +134,7 @@ int HashClassifier::command(int argc, const char*const* argv)
 			if (ep) {
 				long slot = (long)Tcl_GetHashValue(ep);
 				Tcl_DeleteHashEntry(ep);
+				hash_changed(src, dst, fid, -1);
 				tcl.resultf("%lu", slot);
 				return (TCL_OK);
 			}
@@ -180,7 +181,8 @@ public:
 // DestHashClassifier methods
 int DestHashClassifier::classify(Packet *p)
 {
-	int slot= lookup(p);
+	int dst = mshift(hdr_ip::access(p)->daddr());
+	int slot = (dst >= 0 && dst < (int)dense_.size()) ? dense_[dst] : lookup(p);
 	if (slot >= 0 && slot <=maxslot_)
 		return (slot);
 	else if (default_ >= 0)
@@ -188,6 +190,16 @@ int DestHashClassifier::classify(Packet *p)
 	return -1;
 } // HashClassifier::classify
 
+void DestHashClassifier::hash_changed(nsaddr_t, nsaddr_t dst, int, long slot)
+{
+	int d = mshift(dst);
+	if (d < 0 || d >= MAX_DENSE_DST)
+		return;
+	if (d >= (int)dense_.size())
+		dense_.resize(d + 1, -1);
+	dense_[d] = slot;
+}
+
 void DestHashClassifier::do_install(char* dst, NsObject *target) {
 	nsaddr_t d = atoi(dst);
 	int slot = getnxt(target);
@@ -37,6 +37,8 @@
 #include "classifier.h"
 #include "ip.h"
 
+#include <vector>
+
 class Flow;
 
 /* class defs for HashClassifier (base), SrcDest, SrcDestFid HashClassifiers */
@@ -99,10 +101,18 @@ protected:
 	void reset() {
 		Tcl_DeleteHashTable(&ht_);
 		Tcl_InitHashTable(&ht_, keylen_);
+		hash_reset();
 	}
 
 	virtual const char* hashkey(nsaddr_t, nsaddr_t, int)=0; 
 
+	/*
+	 * Every change of the table is reported here (slot -1 for a
+	 * deleted key), so subclasses can keep a faster copy of it.
+	 */
+	virtual void hash_changed(nsaddr_t, nsaddr_t, int, long) {}
+	virtual void hash_reset() {}
+
 	int set_hash(nsaddr_t src, nsaddr_t dst, int fid, long slot) {
 		int newEntry;
 		Tcl_HashEntry *ep= Tcl_CreateHashEntry(&ht_,
@@ -110,6 +120,7 @@ protected:
 						       &newEntry); 
 		if (ep) {
 			Tcl_SetHashValue(ep, slot);
+			hash_changed(src, dst, fid, slot);
 			return slot;
 		}
 		return -1;
@@ -169,16 +180,28 @@ protected:
 	}
 };
 
+/*
+ * The routing table of a flat-addressed node.  Destinations are node
+ * addresses, so besides the Tcl hash table the slots are kept in an
+ * array indexed by destination and classify() is a single index; only
+ * destinations beyond MAX_DENSE_DST are looked up in the hash table.
+ */
 class DestHashClassifier : public HashClassifier {
 public:
-	DestHashClassifier() : HashClassifier(TCL_ONE_WORD_KEYS) {}
+	DestHashClassifier() : HashClassifier(TCL_ONE_WORD_KEYS), dense_() {}
 	virtual int command(int argc, const char*const* argv);
 	int classify(Packet *p);
+	void recv_batch(Packet** p, int n) override { forward_batch(p, n); }
 	virtual void do_install(char *dst, NsObject *target);
 protected:
 	const char* hashkey(nsaddr_t, nsaddr_t dst, int) {
 		long key = mshift(dst);
 		return (const char*) key;
 	}
+	void hash_changed(nsaddr_t src, nsaddr_t dst, int fid, long slot) override;
+	void hash_reset() override { dense_.clear(); }
+
+	static constexpr int MAX_DENSE_DST = 1 << 16;
+	std::vector<int> dense_;	// slot by mshift(dst), -1 for none
 };
 
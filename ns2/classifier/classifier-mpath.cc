@@ -48,18 +48,368 @@
 static const char rcsid[] =
     "@(#) $Header: /cvsroot/nsnam/ns-2/classifier/classifier-mpath.cc,v 1.10 2005/08/25 18:58:01 johnh Exp $ (USC/ISI)";
 
+#include <map>
+#include <vector>
+
 #include "classifier.h"
 #include "ip.h"
+#include "queue.h"
+#include "scheduler.h"
+#include <tools/MultiPathTelemetry.h>
 
+/*
+ * Spreads packets over the installed slots, round robin or, with
+ * perflow_ or checkpathid_, by a hash of the packet's flow.
+ *
+ * The flow hash comes with the packet (hdr_cmn::flow_hash(), set once
+ * per flow by the sending agent) and is only mixed with the node id and
+ * hash_seed_ here; changing hash_seed_ reshuffles which flows collide.
+ * The live slots are kept in live_, so that a hash maps straight to a
+ * next hop.  legacy_hash_ restores the original byte-wise hash with
+ * linear probing, for reproducing paths of earlier runs.
+ *
+ * Two adaptive modes take precedence over the above:
+ *
+ * - flowlet_gap_ > 0: flowlet switching.  A flow keeps its slot until
+ *   it has been idle for flowlet_gap_ seconds; its next packet starts a
+ *   new flowlet on a freshly chosen slot (LetFlow), or on the least
+ *   occupied one with congestion_aware_ (CONGA-like, on local state).
+ *   Flowlets are tracked in a fixed-size table per node, shared by the
+ *   node's multipath classifiers and indexed by flow hash, with the
+ *   last-seen time of each entry as its expiry.
+ * - congestion_aware_ alone: every packet takes the slot whose egress
+ *   queue holds the fewest bytes (packet spraying).
+ *
+ * Occupancy is read from the queues given with attach-queue (done by
+ * Node add-routes); a slot without a queue counts as empty.
+ *
+ * While a MultiPathTelemetry is started, every packet is counted on the
+ * uplink to its slot's next hop (given with next-hop, -1 if unknown).
+ *
+ * Fast local reroute: link-state marks the link to a next hop down (or
+ * up again) for all multipath classifiers of the node, which skip its
+ * slots from their next packet on, without waiting for new routes.
+ * The primary slots still up keep their flows; the flows hashed to a
+ * down slot are spread over the rest.  Slots marked with backup (loop-
+ * free alternates, see Simulator populate-ecmp-classifiers) are only
+ * used once every primary slot is down.  With nothing left up, packets
+ * go to a down slot, whose link drops them.  legacy_hash_ ignores link
+ * states.
+ */
 class MultiPathForwarder : public Classifier {
 public:
-  MultiPathForwarder() : ns_(0), nodeid_(0), nodetype_(0), perflow_(0), checkpathid_(0) {
+  MultiPathForwarder() : ns_(0), nodeid_(0), nodetype_(0), perflow_(0), checkpathid_(0),
+		hash_seed_(0), legacy_hash_(0), flowlet_gap_(0),
+		flowlet_table_size_(0), congestion_aware_(0), flowlets_(0),
+		telemetry_(0), links_(0), links_node_(0), links_version_(0) {
 		bind("nodeid_", &nodeid_);
 		bind("nodetype_", &nodetype_);
 		bind("perflow_", &perflow_);
 		bind("checkpathid_", &checkpathid_);
+		bind("hash_seed_", &hash_seed_);
+		bind("legacy_hash_", &legacy_hash_);
+		bind("flowlet_gap_", &flowlet_gap_);
+		bind("flowlet_table_size_", &flowlet_table_size_);
+		bind("congestion_aware_", &congestion_aware_);
 	}
 	virtual int classify(Packet* p) {
+		int cl = select(p);
+		MultiPathTelemetry* telemetry = MultiPathTelemetry::active();
+		if (telemetry != 0 && cl >= 0)
+			count(telemetry, p, cl);
+		return cl;
+	}
+	/*
+	 * A per-flow hash depends on the packet alone, so packets arriving
+	 * together can all be classified before any is forwarded.  The
+	 * other modes keep state that forwarding can feed back into
+	 * (queue occupancy, the round robin and flowlets of the replies
+	 * of local agents, telemetry order) and take packets one by one.
+	 */
+	virtual void recv_batch(Packet** p, int n) {
+		if ((perflow_ || checkpathid_) && !legacy_hash_ &&
+		    flowlet_gap_ <= 0 && !congestion_aware_ &&
+		    MultiPathTelemetry::active() == 0)
+			forward_batch(p, n);
+		else
+			Classifier::recv_batch(p, n);
+	}
+	virtual void install(int slot, NsObject* p) {
+		Classifier::install(slot, p);
+		update_live();
+	}
+	virtual void clear(int slot) {
+		Classifier::clear(slot);
+		update_live();
+	}
+	virtual int command(int argc, const char*const* argv) {
+		if (argc == 4 && strcmp(argv[1], "attach-queue") == 0) {
+			/*
+			 * $classifier attach-queue $slot $queue
+			 */
+			int slot = atoi(argv[2]);
+			Queue* q = (Queue*)TclObject::lookup(argv[3]);
+			if (slot < 0 || q == 0) {
+				Tcl::instance().resultf("%s: bad slot %s or "
+				    "queue %s", name(), argv[2], argv[3]);
+				return (TCL_ERROR);
+			}
+			if (slot >= (int)queues_.size())
+				queues_.resize(slot + 1);
+			queues_[slot] = q;
+			return (TCL_OK);
+		}
+		if (argc == 4 && strcmp(argv[1], "next-hop") == 0) {
+			/*
+			 * $classifier next-hop $slot $node_id
+			 */
+			int slot = atoi(argv[2]);
+			if (slot < 0) {
+				Tcl::instance().resultf("%s: bad slot %s",
+				    name(), argv[2]);
+				return (TCL_ERROR);
+			}
+			if (slot >= (int)next_hops_.size())
+				next_hops_.resize(slot + 1, -1);
+			next_hops_[slot] = atoi(argv[3]);
+			uplinks_.clear();
+			update_live();
+			return (TCL_OK);
+		}
+		if (argc == 3 && strcmp(argv[1], "backup") == 0) {
+			/*
+			 * $classifier backup $slot
+			 */
+			int slot = atoi(argv[2]);
+			if (slot < 0) {
+				Tcl::instance().resultf("%s: bad slot %s",
+				    name(), argv[2]);
+				return (TCL_ERROR);
+			}
+			if (slot >= (int)backup_.size())
+				backup_.resize(slot + 1, 0);
+			backup_[slot] = 1;
+			update_live();
+			return (TCL_OK);
+		}
+		if (argc == 4 && strcmp(argv[1], "link-state") == 0) {
+			/*
+			 * $classifier link-state $next_hop up|down
+			 */
+			int nh = atoi(argv[2]);
+			int down = strcmp(argv[3], "down") == 0;
+			if (nh < 0 || (!down && strcmp(argv[3], "up") != 0)) {
+				Tcl::instance().resultf("%s: bad next hop %s "
+				    "or link state %s", name(), argv[2],
+				    argv[3]);
+				return (TCL_ERROR);
+			}
+			LinkStates& links = link_states();
+			if (nh >= (int)links.down.size())
+				links.down.resize(nh + 1, 0);
+			links.down[nh] = down;
+			links.version++;
+			return (TCL_OK);
+		}
+		return (Classifier::command(argc, argv));
+	}
+private:
+	int select(Packet* p) {
+		if (legacy_hash_)
+			return legacy_classify(p);
+		if (link_states().version != links_version_)
+			update_live();
+		if (live_.empty())
+			return -1;
+
+		hdr_ip* h = hdr_ip::access(p);
+		unsigned int fh = hdr_cmn::access(p)->flow_hash();
+		if (fh == 0)
+			fh = hdr_cmn::flow_hash(h->saddr(), h->daddr(),
+			    h->flowid());
+		fh = hdr_cmn::mix_hash(fh ^ hdr_cmn::mix_hash(
+		    (unsigned int)nodeid_ ^ (unsigned int)hash_seed_));
+
+		if (flowlet_gap_ > 0)
+			return flowlet_classify(fh);
+		if (congestion_aware_)
+			return least_occupied(fh);
+
+		unsigned int ms_;
+		if (perflow_ || checkpathid_) {
+			ms_ = fh;
+			if (checkpathid_)
+				ms_ += h->prio();
+			return hashed(ms_);
+		}
+		ms_ = ns_;
+		ns_ = (ns_ + 1) % live_.size();
+		return live_[ms_ % live_.size()];
+	}
+
+	/*
+	 * Hashes over the primary slots, so that a flow only moves when its
+	 * own slot goes down; it then takes another live slot.
+	 */
+	int hashed(unsigned int h) {
+		if (primary_.empty())
+			return live_[h % live_.size()];
+		int slot = primary_[h % primary_.size()];
+		if (usable_[slot])
+			return slot;
+		return live_[hdr_cmn::mix_hash(h) % live_.size()];
+	}
+
+	void count(MultiPathTelemetry* telemetry, Packet* p, int cl) {
+		// the uplink counters of each slot, looked up once
+		if (telemetry != telemetry_) {
+			uplinks_.clear();
+			telemetry_ = telemetry;
+		}
+		if (cl >= (int)uplinks_.size())
+			uplinks_.resize(cl + 1, 0);
+		if (uplinks_[cl] == 0)
+			uplinks_[cl] = &telemetry->uplink(nodeid_,
+			    cl < (int)next_hops_.size() ? next_hops_[cl] : -1);
+
+		hdr_ip* h = hdr_ip::access(p);
+		unsigned int fh = hdr_cmn::access(p)->flow_hash();
+		if (fh == 0)
+			fh = hdr_cmn::flow_hash(h->saddr(), h->daddr(),
+			    h->flowid());
+		telemetry->count(*uplinks_[cl], p, fh);
+	}
+
+	struct Flowlet {
+		double last_seen;	// expiry is last_seen + flowlet_gap_
+		unsigned int flow;	// mixed flow hash, to tell entries apart
+		int slot;
+	};
+	typedef std::vector<Flowlet> FlowletTable;
+
+	/*
+	 * One flowlet table per node: a packet only meets the classifier
+	 * of its destination, so the node's classifiers can share it.
+	 */
+	FlowletTable& flowlet_table() {
+		if (flowlets_ == 0) {
+			static std::map<int, FlowletTable> tables;
+			flowlets_ = &tables[nodeid_];
+			if (flowlets_->empty()) {
+				int n = 1;
+				while (n < flowlet_table_size_)
+					n <<= 1;
+				flowlets_->assign(n, Flowlet{-1, 0, -1});
+			}
+		}
+		return *flowlets_;
+	}
+
+	int flowlet_classify(unsigned int fh) {
+		FlowletTable& table = flowlet_table();
+		Flowlet& f = table[fh & (table.size() - 1)];
+		double now = Scheduler::instance().clock();
+		if (f.flow != fh || now - f.last_seen > flowlet_gap_ ||
+		    f.slot < 0 || f.slot >= (int)usable_.size() ||
+		    !usable_[f.slot]) {
+			/*
+			 * New flowlet: LetFlow picks at random, which a
+			 * hash of the flow and start time does reproducibly.
+			 */
+			unsigned long long t;
+			memcpy(&t, &now, sizeof(t));
+			unsigned int r = hdr_cmn::mix_hash(fh ^ (unsigned int)t
+			    ^ (unsigned int)(t >> 32));
+			f.flow = fh;
+			f.slot = congestion_aware_ ? least_occupied(r)
+			    : live_[r % live_.size()];
+		}
+		f.last_seen = now;
+		return f.slot;
+	}
+
+	/*
+	 * Live slot with the fewest bytes queued; ties are broken from a
+	 * position given by h, so that idle slots share the load.
+	 */
+	int least_occupied(unsigned int h) {
+		size_t n = live_.size();
+		size_t start = h % n;
+		int best = -1;
+		int best_bytes = 0;
+		for (size_t i = 0; i < n; i++) {
+			int slot = live_[(start + i) % n];
+			int bytes = occupancy(slot);
+			if (best < 0 || bytes < best_bytes) {
+				best = slot;
+				best_bytes = bytes;
+			}
+		}
+		return best;
+	}
+
+	int occupancy(int slot) {
+		if (slot >= (int)queues_.size() || queues_[slot] == 0)
+			return 0;
+		return queues_[slot]->int_backlog_bytes();
+	}
+
+	struct LinkStates {
+		std::vector<char> down;	// by next hop node id
+		unsigned int version;	// bumped on every change
+	};
+
+	/*
+	 * One set of link states per node, like the flowlet table: the
+	 * links belong to the node, not to any one classifier.
+	 */
+	LinkStates& link_states() {
+		if (links_ == 0 || links_node_ != nodeid_) {
+			static std::map<int, LinkStates> states;
+			links_ = &states[nodeid_];
+			links_node_ = nodeid_;
+		}
+		return *links_;
+	}
+
+	bool link_up(int slot) {
+		LinkStates& links = link_states();
+		int nh = slot < (int)next_hops_.size() ? next_hops_[slot] : -1;
+		return nh < 0 || nh >= (int)links.down.size() || !links.down[nh];
+	}
+
+	/*
+	 * Recomputes the slots to use, after a change of the installed
+	 * slots or of the node's link states.
+	 */
+	void update_live() {
+		links_version_ = link_states().version;
+		primary_.clear();
+		live_.clear();
+		usable_.assign(maxslot_ + 1, 0);
+		std::vector<int> backups;
+		for (int i = 0; i <= maxslot_; i++) {
+			if (slot_[i] == 0)
+				continue;
+			if (i < (int)backup_.size() && backup_[i]) {
+				backups.push_back(i);
+				continue;
+			}
+			primary_.push_back(i);
+			if (link_up(i))
+				live_.push_back(i);
+		}
+		if (live_.empty())
+			for (int slot : backups)
+				if (link_up(slot))
+					live_.push_back(slot);
+		for (int slot : live_)
+			usable_[slot] = 1;
+		if (live_.empty())
+			live_ = primary_.empty() ? backups : primary_;
+	}
+
+	int legacy_classify(Packet* p) {
       	int cl;
 		hdr_ip* h = hdr_ip::access(p);
 		// Mohammad: multipath support
@@ -109,13 +459,30 @@ public:
 
 		return cl;
 	}
-private:
+
 	int ns_;
 	// Mohamamd: adding support for perflow multipath
 	int nodeid_;
     int nodetype_;
 	int perflow_;
 	int checkpathid_;
+	int hash_seed_;
+	int legacy_hash_;
+	std::vector<int> live_;	// slots in use, in order
+	std::vector<int> primary_;	// installed slots but the backups
+	std::vector<char> usable_;	// per slot: installed, up, in use
+	std::vector<char> backup_;	// per slot: a backup slot
+	double flowlet_gap_;
+	int flowlet_table_size_;
+	int congestion_aware_;
+	FlowletTable* flowlets_;	// this node's, once first used
+	std::vector<Queue*> queues_;	// egress queue of each slot
+	std::vector<int> next_hops_;	// node id behind each slot
+	MultiPathTelemetry* telemetry_;	// the one uplinks_ belong to
+	std::vector<MultiPathTelemetry::Uplink*> uplinks_;
+	LinkStates* links_;	// this node's, once first used
+	int links_node_;	// nodeid_ when links_ was looked up
+	unsigned int links_version_;	// of links_, when live_ was made
 
 	static unsigned int
 	HashString(const char *bytes,int length)
@@ -153,6 +153,35 @@ void Classifier::recv(Packet* p, Handler*h)
 	node->recv(p,h);
 }
 
+/*
+ * Classify the whole batch first, then hand each run of packets going
+ * to the same object over in one recv_batch.  Forwarding a packet must
+ * not change how the ones after it are classified, which holds when
+ * classify() looks at nothing but the packet.
+ */
+void Classifier::forward_batch(Packet** p, int n)
+{
+	NsObject* next[Scheduler::MAX_BATCH];
+	for (int i = 0; i < n; ++i)
+		next[i] = find(p[i]);
+
+	for (int i = 0, j; i < n; i = j) {
+		NsObject* node = next[i];
+		for (j = i; j < n && next[j] == node; ++j) {
+			if (node == NULL)
+				Packet::free(p[j]);	// as in recv
+			else
+				p[j]->owner_ = node;
+		}
+		if (node == NULL)
+			continue;
+		if (j - i == 1)
+			node->recv(p[i]);
+		else
+			node->recv_batch(p + i, j - i);
+	}
+}
+
 /*
  * perform the mapping from packet to object
  * perform upcall if no mapping
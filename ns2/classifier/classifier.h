@@ -58,6 +58,8 @@ public:
 	}
 
 	virtual void recv(Packet* p, Handler* h);
+	bool batchable() const { return true; }
+	void handle_batch(Event** e, int n) { handle_packets(e, n); }
 	virtual NsObject* find(Packet*);
 	virtual int classify(Packet *);
 	virtual void clear(int slot);
@@ -78,6 +80,9 @@ public:
 protected:
 	virtual int getnxt(NsObject *);
 	virtual int command(int argc, const char*const* argv);
+	// recv_batch for classifiers whose classify() depends on the
+	// packet alone
+	void forward_batch(Packet** p, int n);
 	void alloc(int);
 	NsObject** slot_;	/* table that maps slot number to a NsObject */
 	int nslot_;
@@ -83,6 +83,7 @@ Agent::delay_bind_init_all()
 	delay_bind_init_one("flags_");
 	delay_bind_init_one("ttl_");
 	delay_bind_init_one("class_");
+	delay_bind_init_one("flow_hash_");
 	Connector::delay_bind_init_all();
 }
 
@@ -98,6 +99,7 @@ Agent::delay_bind_dispatch(const char *varName, const char *localName, TclObject
 	if (delay_bind(varName, localName, "flags_", (int*)&flags_, tracer)) return TCL_OK;
 	if (delay_bind(varName, localName, "ttl_", &defttl_, tracer)) return TCL_OK;
 	if (delay_bind(varName, localName, "class_", (int*)&fid_, tracer)) return TCL_OK;
+	if (delay_bind(varName, localName, "flow_hash_", &flow_hash_, tracer)) return TCL_OK;
 	return Connector::delay_bind_dispatch(varName, localName, tracer);
 }
 
@@ -474,6 +476,13 @@ Agent::initpkt(Packet* p) const
 	iph->prio() = prio_;
 	iph->ttl() = defttl_;
 
+	/*
+	 * The flow's multipath hash, so that switches need not hash the
+	 * addresses of every packet (see Classifier/MultiPath).
+	 */
+	ch->flow_hash() = flow_hash_ ? (unsigned int)flow_hash_
+	    : hdr_cmn::flow_hash(here_.addr_, dst_.addr_, fid_);
+
 	hdr_flags* hf = hdr_flags::access(p);
 	hf->ecn_capable_ = 0;
 	hf->ecn_ = 0;
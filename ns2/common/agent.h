@@ -122,6 +122,7 @@ class Agent : public Connector {
 	int prio_;			// for IPv6 prio field
 	int flags_;			// for experiments (see ip.h)
 	int defttl_;			// default ttl for outgoing pkts
+	int flow_hash_;			// multipath flow hash, 0 to derive it
 
 #ifdef notdef
 	int seqno_;		/* current seqno */
@@ -65,6 +65,8 @@ struct hdr_flags {
 	unsigned char qs_;	/* Packet is from Quick-Start window, i.e.
 				 * a window following an approved QS request.
 				 */
+	unsigned char trimmable_; /* sender understands trimmed packets */
+	unsigned char trimmed_;	/* payload was cut by a queue (queue/trim.h) */
 	/*
 	 * these functions use the newer ECN names but leaves the actual field
 	 * names above to maintain backward compat
@@ -92,6 +92,25 @@ void NsObject::handle(Event* e)
 	recv((Packet*)e);
 }
 
+void NsObject::handle_packets(Event** e, int n)
+{
+	Packet* p[Scheduler::MAX_BATCH];
+	for (int i = 0; i < n; ++i)
+		p[i] = (Packet*)e[i];
+	recv_batch(p, n);
+}
+
+/*
+ * Packets arriving together, at most Scheduler::MAX_BATCH of them.
+ * Objects that can do better than one recv at a time (e.g. classify
+ * them all first) override this; the result must be the same.
+ */
+void NsObject::recv_batch(Packet** p, int n)
+{
+	for (int i = 0; i < n; ++i)
+		recv(p[i]);
+}
+
 void NsObject::recv(Packet *p, const char*)
 {
 	Packet::free(p);
@@ -51,6 +51,8 @@ public:
 	// Monarch extn - used for logging reasons why the 
 	// pkt is handed off (eg droptargets)
 	virtual void recv(Packet* p, const char* s);
+	// n packets arriving at the same time, by default recv'd in turn
+	virtual void recv_batch(Packet** p, int n);
 	
 	//added for queue tracing -  ratul
 	virtual void recvOnly(Packet *) {};
@@ -63,6 +65,8 @@ public:
 protected:
 	virtual void reset();
 	void handle(Event*);
+	// handle_batch for subclasses whose handle() is the one above
+	void handle_packets(Event**, int);
 	int debug_;
 };
 
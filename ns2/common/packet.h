@@ -210,8 +210,11 @@ static const packet_t PT_MDART = 72;
 
 static const packet_t PT_DELAY = 73;
 
+        // receiver-driven transports (tcp/rd-agent.h)
+static const packet_t PT_RD = 74;
+
         // insert new packet types here
-static packet_t       PT_NTYPE = 74; // This MUST be the LAST one
+static packet_t       PT_NTYPE = 75; // This MUST be the LAST one
 
 enum packetClass
 {
@@ -429,6 +432,7 @@ public:
 		name_[PT_DCCP_RESET]="DCCP_Reset";
 
 		name_[PT_DELAY] = "DELAY";
+		name_[PT_RD] = "RD";
 
 		name_[PT_NTYPE]= "undefined";
 	}
@@ -703,6 +707,34 @@ struct hdr_cmn {
 
 	ModulationScheme mod_scheme_;
 	inline ModulationScheme& mod_scheme() { return (mod_scheme_); }
+
+	// per-flow hash for multipath forwarding, set by the sending agent
+	// (0: not set, see flow_hash() below)
+	unsigned int flow_hash_;
+	inline unsigned int& flow_hash() { return (flow_hash_); }
+
+	/*
+	 * Finalizer of MurmurHash3: a cheap integer mix in which every
+	 * input bit affects every output bit.
+	 */
+	static inline unsigned int mix_hash(unsigned int h) {
+		h ^= h >> 16;
+		h *= 0x85ebca6bU;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35U;
+		h ^= h >> 16;
+		return h;
+	}
+	/*
+	 * Hash of a flow's source, destination and flow id; never 0, so
+	 * that it can be told from an unset flow_hash_.
+	 */
+	static inline unsigned int flow_hash(int src, int dst, int fid) {
+		unsigned int h = mix_hash((unsigned int)src * 0x9e3779b9U
+		    ^ (unsigned int)dst);
+		h = mix_hash(h ^ (unsigned int)fid);
+		return h ? h : 1;
+	}
 };
 
 
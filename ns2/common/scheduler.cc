@@ -59,8 +59,9 @@ scheduler_uid_t Scheduler::uid_ = 1;
 // 	char* proc_;
 // };
 
-Scheduler::Scheduler() : clock_(SCHED_START), halted_(0)
+Scheduler::Scheduler() : clock_(SCHED_START), halted_(0), batch_(1)
 {
+	bind("batch_", &batch_);
 }
 
 Scheduler::~Scheduler(){
@@ -125,7 +126,10 @@ Scheduler::run()
 	 * Patch by Thomas Kaemer <Thomas.Kaemer@eas.iis.fhg.de>.
 	 */
 	while (!halted_ && (p = deque())) {
-		dispatch(p, p->time_);
+		if (batch_ > 1)
+			dispatch_batch(p);
+		else
+			dispatch(p, p->time_);
 	}
 }
 
@@ -155,6 +159,45 @@ Scheduler::dispatch(Event* p)
 	dispatch(p, p->time_);
 }
 
+/*
+ * Dispatch p together with the events right behind it that are due at
+ * the same time for the same handler, up to batch_ of them, through a
+ * single handle_batch.  Only batchable() handlers (packet arrivals at
+ * classifiers and queues) are batched: their events would have been
+ * dispatched back to back anyway, as same-time events are dequeued in
+ * the order they were scheduled and whatever the batch schedules for
+ * now still comes after all of it.  Other handlers may cancel pending
+ * events or halt the run from handle(), and go through dispatch().
+ */
+void
+Scheduler::dispatch_batch(Event* p)
+{
+	const Event* next = head();
+	if (next == 0 || !p->handler_->batchable() || next->time_ != p->time_ ||
+	    next->handler_ != p->handler_) {
+		dispatch(p, p->time_);
+		return;
+	}
+	if (p->time_ < clock_) {
+		fprintf(stderr, "ns: scheduler going backwards in time from %f to %f.\n", clock_, p->time_);
+		abort();
+	}
+
+	Event* batch[MAX_BATCH];
+	int limit = batch_ < MAX_BATCH ? batch_ : MAX_BATCH;
+	int n = 0;
+	batch[n++] = p;
+	do {
+		batch[n++] = deque();
+	} while (n < limit && (next = head()) != 0 &&
+	    next->time_ == p->time_ && next->handler_ == p->handler_);
+
+	clock_ = p->time_;
+	for (int i = 0; i < n; ++i)
+		batch[i]->uid_ = -batch[i]->uid_;	// being dispatched
+	p->handler_->handle_batch(batch, n);
+}
+
 class AtEvent : public Event {
 public:
 	AtEvent() : proc_(0) {
@@ -72,6 +72,20 @@ class Handler {
  public:
 	virtual ~Handler () {}
 	virtual void handle(Event* event) = 0;
+	/*
+	 * Called instead of handle() with n > 1 events due at the same
+	 * time for this handler, in the order handle() would have seen
+	 * them (see Scheduler batch_), if batchable().  Handlers that can
+	 * take them in one go override both.  Batched events are taken off
+	 * the queue before any of them runs, so a handler whose events can
+	 * cancel their followers or halt the run (AtHandler) must not be
+	 * batchable.
+	 */
+	virtual bool batchable() const { return false; }
+	virtual void handle_batch(Event** events, int n) {
+		for (int i = 0; i < n; ++i)
+			handle(events[i]);
+	}
 };
 
 #define	SCHED_START	0.0	/* start time (secs) */
@@ -99,15 +113,18 @@ public:
 		return SCHED_START;
 	}
 	virtual void reset();
+	enum { MAX_BATCH = 64 };	// upper bound of batch_
 protected:
 	void dumpq();	// for debug: remove + print remaining events
 	void dispatch(Event*);	// execute an event
 	void dispatch(Event*, double);	// exec event, set clock_
+	void dispatch_batch(Event*);	// exec event and same-time followers
 	Scheduler();
 	virtual ~Scheduler();
 	int command(int argc, const char*const* argv);
 	double clock_;
 	int halted_;
+	int batch_;		// max events per handle_batch, 1: off
 	static Scheduler* instance_;
 	static scheduler_uid_t uid_;
 };
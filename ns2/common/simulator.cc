@@ -44,8 +44,15 @@
  *
  */
 
+#include <algorithm>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
 #include "simulator.h"
 #include "node.h"
+#include "route.h"
 #include "address.h"
 #include "object.h"
 
@@ -71,6 +78,10 @@ int Simulator::command(int argc, const char*const* argv) {
 			populate_flat_classifiers();
 			return TCL_OK;
 		}
+		if (strcmp(argv[1], "populate-ecmp-classifiers") == 0) {
+			nn_ = atoi(argv[2]);
+			return populate_ecmp_classifiers();
+		}
 		if (strcmp(argv[1], "populate-hier-classifiers") == 0) {
 			nn_ = atoi(argv[2]);
 			populate_hier_classifiers();
@@ -198,6 +209,101 @@ void Simulator::populate_flat_classifiers() {
 }
 
 
+/*
+ * Installs every equal-cost route of the RouteLogic's sparse engine (see
+ * Simulator compute-ecmp-routes): single next hops point at the link,
+ * sets of next hops at a Classifier/MultiPath of the node, one per
+ * distinct set, made by Node ecmp-classifier (one per destination for
+ * round robin, see Node ecmp-shared?).  With the RouteLogic's
+ * lfa_, the loop-free alternates of a route go into its classifier as
+ * backup slots, so a route with backups gets one even for a single
+ * next hop.  Unreachable destinations are routed to the null agent, so
+ * that a recompute after a link failure does not leave them on the
+ * dead path.
+ */
+int Simulator::populate_ecmp_classifiers() {
+	Tcl& tcl = Tcl::instance();
+	SparseRoutes const* routes = rtobject_ ? rtobject_->sparse_routes() : 0;
+	if (routes == 0 || !routes->computed()) {
+		tcl.result("populate-ecmp-classifiers: no sparse routes computed");
+		return TCL_ERROR;
+	}
+	if (nodelist_ == NULL)
+		return TCL_OK;
+	if (tcl.evalc("Node ecmp-shared?") != TCL_OK)
+		return TCL_ERROR;
+	bool shared = atoi(tcl.result()) != 0;
+	if (tcl.evalf("%s nullagent", name()) != TCL_OK)
+		return TCL_ERROR;
+	NsObject* nullagent = (NsObject*)TclObject::lookup(tcl.result());
+
+	char tmp[SMALL_LEN];
+	int n = std::min(nn_, routes->size());
+	check(nn_);
+	for (int i = 0; i < nn_; i++) {
+		if (nodelist_[i] == NULL)
+			continue;
+		nodelist_[i]->set_table_size(nn_);
+
+		std::vector<std::vector<int> > backups;
+		if (i < n && rtobject_->lfa())
+			backups = routes->loop_free_alternates(i);
+
+		// the engine hands out one vector per distinct set of a node;
+		// the destination is -1 when shared
+		typedef std::tuple<std::vector<int> const*, std::vector<int>,
+		    int> MPathKey;
+		std::map<int, NsObject*> heads;
+		std::map<MPathKey, NsObject*> mpaths;
+		for (int j = 0; j < nn_; j++) {
+			if (i == j)
+				continue;
+			// nodes past the engine's have no up links left
+			if (i >= n || j >= n ||
+			    routes->next_hops(i, j).empty()) {
+				sprintf(tmp, "%d", j);
+				nodelist_[i]->delete_route(tmp, nullagent);
+				continue;
+			}
+			std::vector<int> const& hops = routes->next_hops(i, j);
+			std::vector<int> alt;
+			if (!backups.empty())
+				alt.swap(backups[j]);
+
+			NsObject* target;
+			if (hops.size() == 1 && alt.empty()) {
+				NsObject*& head = heads[hops[0]];
+				if (head == 0)
+					head = get_link_head(nodelist_[i], hops[0]);
+				target = head;
+			} else {
+				NsObject*& mpath =
+				    mpaths[MPathKey(&hops, alt, shared ? -1 : j)];
+				if (mpath == 0) {
+					std::string list, backup_list;
+					for (int nh : hops)
+						list += " " + std::to_string(nh);
+					for (int nh : alt)
+						backup_list += " " +
+						    std::to_string(nh);
+					if (tcl.evalf("%s ecmp-classifier {%s} {%s} %s",
+					    nodelist_[i]->name(), list.c_str(),
+					    backup_list.c_str(),
+					    shared ? "" : std::to_string(j).c_str())
+					    != TCL_OK)
+						return TCL_ERROR;
+					mpath = (NsObject*)TclObject::lookup(
+					    tcl.result());
+				}
+				target = mpath;
+			}
+			sprintf(tmp, "%d", j);
+			nodelist_[i]->add_route(tmp, target);
+		}
+	}
+	return TCL_OK;
+}
+
 void Simulator::populate_hier_classifiers() {
 	// Set up each classifer (aka node) to act as a router.
 	// Point each classifer table to the link object that
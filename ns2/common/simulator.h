@@ -69,6 +69,7 @@ public:
 	int command(int argc, const char*const* argv);
 	void populate_flat_classifiers();
 	void populate_hier_classifiers();
+	int populate_ecmp_classifiers();
 	void add_node(ParentNode *node, int id);
 	NsObject* get_link_head(ParentNode *node, int nh);
 	int node_id_by_addr(int address);
@@ -0,0 +1,14 @@
+#include "telemetry.h"
+
+int hdr_int::offset_;
+
+namespace {
+
+class IntHeaderClass : public PacketHeaderClass {
+public:
+    IntHeaderClass() : PacketHeaderClass("PacketHeader/INT", sizeof(hdr_int)) {
+        bind_offset(&hdr_int::offset_);
+    }
+} class_inthdr;
+
+}
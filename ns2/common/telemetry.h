@@ -0,0 +1,40 @@
+#ifndef ns_telemetry_h
+#define ns_telemetry_h
+
+#include "packet.h"
+
+/*
+ * In-band network telemetry (INT).
+ *
+ * A sender that sets collect_ asks every queue on the path to append one
+ * IntHop record when the packet leaves it (see Queue::stamp_int, enabled
+ * per queue with int_enabled_).  The receiver copies the records of the
+ * last data packet into its ACK with collect_ cleared, so the ACK path
+ * does not append to them.
+ */
+struct IntHop {
+    double ts_;         // time the packet left the queue
+    double rate_;       // link rate, bits per second
+    double tx_bytes_;   // bytes the queue has sent so far, this packet included
+    int qlen_;          // bytes left in the queue behind this packet
+};
+
+struct hdr_int {
+    static constexpr int MAX_HOPS = 8;
+
+    int collect_;       // bool: queues append hop records
+    int nhops_;
+    IntHop hops_[MAX_HOPS];
+
+    void push(IntHop const& hop) {
+        if (nhops_ < MAX_HOPS)
+            hops_[nhops_++] = hop;
+    }
+
+    static int offset_;
+    inline static auto access(Packet const * p) -> hdr_int* {
+        return reinterpret_cast<hdr_int*>(p->access(offset_));
+    }
+};
+
+#endif
@@ -49,6 +49,14 @@ public:
 	}
 } class_delay_link;
 
+static class TTLDelayLinkClass : public TclClass {
+public:
+	TTLDelayLinkClass() : TclClass("DelayLink/TTL") {}
+	TclObject* create(int /* argc */, const char*const* /* argv */) {
+		return (new TTLDelayLink);
+	}
+} class_ttl_delay_link;
+
 LinkDelay::LinkDelay() 
 	: dynamic_(0), 
 	  latest_time_(0),
@@ -109,6 +117,19 @@ void LinkDelay::recv(Packet* p, Handler* h)
 	s.schedule(h, &intr_, txt);
 }
 
+void TTLDelayLink::recv(Packet* p, Handler* h)
+{
+	hdr_ip* iph = hdr_ip::access(p);
+	int ttl = iph->ttl() - 1;
+	if (ttl <= 0) {
+		Scheduler::instance().schedule(h, &intr_, txtime(p));
+		drop(p);
+		return;
+	}
+	iph->ttl() = ttl;
+	LinkDelay::recv(p, h);
+}
+
 void LinkDelay::send(Packet* p, Handler*)
 {
 	target_->recv(p, (Handler*) NULL);
@@ -72,4 +72,16 @@ class LinkDelay : public Connector {
 				 *  changes */
 };
 
+/*
+ * DelayLink that also does the TTLChecker's job, for the fast SimpleLink
+ * (see SimpleLink set fast_): one object and one recv per hop instead of
+ * two.  The TTL is checked when the packet starts transmission rather
+ * than when it arrives, so an expired packet still holds the link for
+ * its transmission time but is dropped (to drop-target) right away.
+ */
+class TTLDelayLink : public LinkDelay {
+ public:
+	void recv(Packet* p, Handler* h);
+};
+
 #endif
@@ -66,6 +66,8 @@
 
 #include "ls.h"
 
+#include <algorithm>
+
 // a global variable
 LsMessageCenter LsMessageCenter::msgctr_;
 
@@ -543,7 +545,7 @@ void LsRouting::linkStateChanged ()
 	// Note: we do want to send link states before topo
 	bool changed=linkStateDatabase_.update(myNodeId_, *linkStateListPtr_);
 	if (changed) {
-		computeRoutes();
+		computeRoutes(myNodeId_);
 		sendLinkStates(/* buffer before sending */ true); 
 		// tcl code will call sendBufferedMessage
 	}
@@ -663,7 +665,7 @@ bool LsRouting::receiveLSA(int senderId, LsMessage* msgPtr)
 						 *(msgPtr->lslPtr_));
 	if (changed)
 		// linkstate database has changed, re-compute routes
-		computeRoutes();
+		computeRoutes(msgPtr->originNodeId_);
 	return changed;
 }
 
@@ -846,6 +848,323 @@ void LsRouting::sendBufferedMessages()
 	messageBuffer_.eraseAll();
 }
 
+void LsRouting::computeRoutes(int nodeId)
+{
+	if (routingTablePtr_ != NULL) {
+		delete routingTablePtr_;
+		routingTablePtr_ = NULL;
+	}
+	if (fastSpf_) {
+		spf_.update(linkStateDatabase_, myNodeId_, nodeId);
+		if (spf_.valid())
+			return;
+	}
+	routingTablePtr_ = _computeRoutes();
+}
+
+/*
+  LsSpf methods
+*/
+void LsSpf::reset(const LsTopoMap& topo, int root)
+{
+	root_ = root;
+	valid_ = true;
+
+	int n = root + 1;
+	int links = 0;
+	for (LsTopoMap::const_iterator itr = topo.begin(); 
+	     itr != topo.end(); itr++) {
+		n = std::max(n, (*itr).first + 1);
+		for (LsLinkStateList::const_iterator itrLink = 
+			     (*itr).second.begin();
+		     itrLink != (*itr).second.end(); itrLink++) {
+			n = std::max(n, (*itrLink).neighborId_ + 1);
+			links++;
+		}
+	}
+
+	outStart_.assign(n + 1, 0);
+	src_.resize(links);
+	dst_.resize(links);
+	cost_.resize(links);
+	inStart_.assign(n + 1, 0);
+	inLink_.resize(links);
+	changed_.clear();
+
+	// the map is ordered by node id, as the links must be
+	int e = 0;
+	for (LsTopoMap::const_iterator itr = topo.begin(); 
+	     itr != topo.end(); itr++) {
+		int u = (*itr).first;
+		for (LsLinkStateList::const_iterator itrLink = 
+			     (*itr).second.begin();
+		     itrLink != (*itr).second.end(); itrLink++, e++) {
+			src_[e] = u;
+			dst_[e] = (*itrLink).neighborId_;
+			cost_[e] = ((*itrLink).status_ == LS_STATUS_UP) ?
+				(*itrLink).cost_ : LINK_DOWN;
+			if ((*itrLink).status_ == LS_STATUS_UP &&
+			    (*itrLink).cost_ <= 0)
+				valid_ = false;
+			outStart_[u + 1]++;
+			inStart_[dst_[e] + 1]++;
+		}
+	}
+	for (int u = 0; u < n; u++) {
+		outStart_[u + 1] += outStart_[u];
+		inStart_[u + 1] += inStart_[u];
+	}
+	std::vector<int> fill(inStart_.begin(), inStart_.end() - 1);
+	for (e = 0; e < links; e++)
+		inLink_[fill[dst_[e]]++] = e;
+
+	dist_.assign(n, UNREACHABLE);
+	nextHops_.assign(n, std::vector<int>());
+	affected_.assign(n, 0);
+	heap_.clear();
+	heapPos_.assign(n, -1);
+	heapKey_.assign(n, UNREACHABLE);
+	if (valid_)
+		computeAll();
+}
+
+void LsSpf::update(const LsTopoMap& topo, int root, int nodeId)
+{
+	if (root != root_ || !valid_) {
+		reset(topo, root);
+		return;
+	}
+	changed_.clear();
+	if (nodeId == LS_INVALID_NODE_ID) {
+		for (LsTopoMap::const_iterator itr = topo.begin(); 
+		     itr != topo.end(); itr++)
+			if (!diff((*itr).first, (*itr).second)) {
+				reset(topo, root);
+				return;
+			}
+	} else {
+		LsTopoMap::const_iterator itr = topo.find(nodeId);
+		if (itr != topo.end() && !diff(nodeId, (*itr).second)) {
+			reset(topo, root);
+			return;
+		}
+	}
+	if (!changed_.empty())
+		computeChanged();
+}
+
+// collect the changed links of nodeId, false if any was added or removed
+bool LsSpf::diff(int nodeId, const LsLinkStateList& lsl)
+{
+	if (nodeId + 1 >= (int)outStart_.size())
+		return false;
+	int e = outStart_[nodeId];
+	for (LsLinkStateList::const_iterator itrLink = lsl.begin();
+	     itrLink != lsl.end(); itrLink++, e++) {
+		if (e == outStart_[nodeId + 1] || 
+		    dst_[e] != (*itrLink).neighborId_)
+			return false;
+		if ((*itrLink).status_ == LS_STATUS_UP && 
+		    (*itrLink).cost_ <= 0)
+			return false; // reset() will find out
+		int cost = ((*itrLink).status_ == LS_STATUS_UP) ?
+			(*itrLink).cost_ : LINK_DOWN;
+		if (cost != cost_[e])
+			changed_.push_back(std::make_pair(e, cost));
+	}
+	return e == outStart_[nodeId + 1];
+}
+
+void LsSpf::computeAll()
+{
+	std::fill(dist_.begin(), dist_.end(), (int)UNREACHABLE);
+	for (size_t i = 0; i < nextHops_.size(); i++)
+		nextHops_[i].clear();
+	dist_[root_] = 0;
+	nextHops_[root_].push_back(root_);
+	for (int e = outStart_[root_]; e < outStart_[root_ + 1]; e++)
+		if (cost_[e] != LINK_DOWN)
+			heapPush(dst_[e], cost_[e]);
+	settle();
+}
+
+void LsSpf::computeChanged()
+{
+	// nodes below a link that got worse, on the old shortest path DAG
+	std::vector<int> affected;
+	for (size_t i = 0; i < changed_.size(); i++) {
+		int e = changed_[i].first, cost = changed_[i].second;
+		int u = src_[e], v = dst_[e];
+		bool worse = cost_[e] != LINK_DOWN && 
+			(cost == LINK_DOWN || cost > cost_[e]);
+		if (worse && dist_[u] != UNREACHABLE && !affected_[v] &&
+		    dist_[u] + cost_[e] == dist_[v]) {
+			affected_[v] = 1;
+			affected.push_back(v);
+		}
+	}
+	for (size_t i = 0; i < affected.size(); i++) {
+		int x = affected[i];
+		for (int e = outStart_[x]; e < outStart_[x + 1]; e++) {
+			int w = dst_[e];
+			if (cost_[e] != LINK_DOWN && !affected_[w] && 
+			    dist_[x] + cost_[e] == dist_[w]) {
+				affected_[w] = 1;
+				affected.push_back(w);
+			}
+		}
+	}
+
+	std::vector<int> oldCost(changed_.size());
+	for (size_t i = 0; i < changed_.size(); i++) {
+		oldCost[i] = cost_[changed_[i].first];
+		cost_[changed_[i].first] = changed_[i].second;
+	}
+
+	// the affected nodes start over from their unaffected neighbors
+	for (size_t i = 0; i < affected.size(); i++) {
+		dist_[affected[i]] = UNREACHABLE;
+		nextHops_[affected[i]].clear();
+	}
+	for (size_t i = 0; i < affected.size(); i++) {
+		int x = affected[i];
+		for (int j = inStart_[x]; j < inStart_[x + 1]; j++) {
+			int e = inLink_[j], y = src_[e];
+			if (cost_[e] != LINK_DOWN && !affected_[y] &&
+			    dist_[y] != UNREACHABLE)
+				heapPush(x, dist_[y] + cost_[e]);
+		}
+	}
+	// and links that got better may offer new or more paths
+	for (size_t i = 0; i < changed_.size(); i++) {
+		int e = changed_[i].first, u = src_[e], v = dst_[e];
+		bool better = cost_[e] != LINK_DOWN &&
+			(oldCost[i] == LINK_DOWN || cost_[e] < oldCost[i]);
+		if (better && !affected_[u] && dist_[u] != UNREACHABLE &&
+		    v != root_ && dist_[u] + cost_[e] <= dist_[v])
+			heapPush(v, dist_[u] + cost_[e]);
+	}
+	for (size_t i = 0; i < affected.size(); i++)
+		affected_[affected[i]] = 0;
+	changed_.clear();
+	settle();
+}
+
+/*
+  Dijkstra over the nodes in the heap.  A node popped at cost k takes
+  its next hops from all its in-links on a path of cost k: those come
+  from nodes closer to the root (costs are positive), which are final
+  by then.  Its out-links are only relaxed if that changed anything.
+*/
+void LsSpf::settle()
+{
+	std::vector<int> hops;
+	while (!heap_.empty()) {
+		int x = heapPop();
+		int k = heapKey_[x];
+		hops.clear();
+		for (int j = inStart_[x]; j < inStart_[x + 1]; j++) {
+			int e = inLink_[j], y = src_[e];
+			if (cost_[e] == LINK_DOWN || dist_[y] == UNREACHABLE ||
+			    dist_[y] + cost_[e] != k)
+				continue;
+			if (y == root_)
+				hops.push_back(x);
+			else
+				hops.insert(hops.end(), nextHops_[y].begin(),
+					    nextHops_[y].end());
+		}
+		std::sort(hops.begin(), hops.end());
+		hops.erase(std::unique(hops.begin(), hops.end()), hops.end());
+		if (k == dist_[x] && hops == nextHops_[x])
+			continue;
+		dist_[x] = k;
+		nextHops_[x].swap(hops);
+
+		for (int e = outStart_[x]; e < outStart_[x + 1]; e++) {
+			int w = dst_[e];
+			if (cost_[e] != LINK_DOWN && w != root_ &&
+			    k + cost_[e] <= dist_[w])
+				heapPush(w, k + cost_[e]);
+		}
+	}
+}
+
+bool LsSpf::lookup(int destId, LsEqualPaths& paths) const
+{
+	if (destId < 0 || destId >= (int)dist_.size() || 
+	    dist_[destId] == UNREACHABLE)
+		return false;
+	paths.cost = dist_[destId];
+	paths.nextHopList.assign(nextHops_[destId].begin(), 
+				 nextHops_[destId].end());
+	return true;
+}
+
+// insert node, or lower its key
+void LsSpf::heapPush(int node, int key)
+{
+	int i = heapPos_[node];
+	if (i < 0) {
+		i = heap_.size();
+		heap_.push_back(node);
+		heapPos_[node] = i;
+	} else if (key >= heapKey_[node])
+		return;
+	heapKey_[node] = key;
+	siftUp(i);
+}
+
+int LsSpf::heapPop()
+{
+	int top = heap_.front();
+	heapPos_[top] = -1;
+	int last = heap_.back();
+	heap_.pop_back();
+	if (!heap_.empty()) {
+		heap_[0] = last;
+		heapPos_[last] = 0;
+		siftDown(0);
+	}
+	return top;
+}
+
+void LsSpf::siftUp(int i)
+{
+	int node = heap_[i];
+	while (i > 0) {
+		int parent = (i - 1) / 2;
+		if (heapKey_[heap_[parent]] <= heapKey_[node])
+			break;
+		heap_[i] = heap_[parent];
+		heapPos_[heap_[i]] = i;
+		i = parent;
+	}
+	heap_[i] = node;
+	heapPos_[node] = i;
+}
+
+void LsSpf::siftDown(int i)
+{
+	int n = heap_.size();
+	int node = heap_[i];
+	for (;;) {
+		int child = 2 * i + 1;
+		if (child >= n)
+			break;
+		if (child + 1 < n && 
+		    heapKey_[heap_[child + 1]] < heapKey_[heap_[child]])
+			child++;
+		if (heapKey_[node] <= heapKey_[heap_[child]])
+			break;
+		heap_[i] = heap_[child];
+		heapPos_[heap_[i]] = i;
+		i = child;
+	}
+	heap_[i] = node;
+	heapPos_[node] = i;
+}
+
 // private _computeRoutes, called by public computeRoutes
 LsPaths* LsRouting::_computeRoutes () 
 {
@@ -68,6 +68,7 @@
 #include <list>
 #include <map>
 #include <utility>
+#include <vector>
 
 #include "timer-handler.h"
 
@@ -345,6 +346,70 @@ private:
 	iterator findMinEqualPaths();
 };
 
+/*
+  LsSpf -- an alternative to LsRouting::_computeRoutes for large
+  topologies, selected with Agent/rtProto/LS set fast_spf_ 1
+
+  The link state database is mirrored in flat arrays (the out-links of
+  every node, and its in-links by index into those) and Dijkstra runs
+  on an indexed binary heap.  After a change only the nodes whose paths
+  may have changed are recomputed: the ones below a link that got worse
+  and the ones a better link now reaches as soon or sooner.  A link
+  added to or removed from a node's list rebuilds the arrays and
+  recomputes everything.
+
+  The results are those of _computeRoutes, all equal-cost next hops
+  included, except that next hops are in increasing node id order.
+  Link costs must be positive; valid() is false otherwise and LsRouting
+  falls back to _computeRoutes.
+*/
+class LsSpf {
+public:
+	LsSpf() : root_(LS_INVALID_NODE_ID), valid_(false) {}
+
+	// mirror topo and compute the paths of root from scratch
+	void reset(const LsTopoMap& topo, int root);
+	// catch up with the link states of nodeId in topo (of every node if
+	// LS_INVALID_NODE_ID); a new root starts from scratch
+	void update(const LsTopoMap& topo, int root,
+		    int nodeId = LS_INVALID_NODE_ID);
+	bool valid() const { return valid_; }
+	// cost and next hops to destId, false if unreachable
+	bool lookup(int destId, LsEqualPaths& paths) const;
+
+private:
+	enum { UNREACHABLE = 0x7fffffff, LINK_DOWN = -1 };
+
+	bool diff(int nodeId, const LsLinkStateList& lsl);
+	void computeAll();
+	void computeChanged();
+	void settle();
+	void heapPush(int node, int key);
+	int heapPop();
+	void siftUp(int i);
+	void siftDown(int i);
+
+	int root_;
+	bool valid_;
+	// links, by source: those of node u are [outStart_[u], outStart_[u+1])
+	std::vector<int> outStart_;
+	std::vector<int> src_;
+	std::vector<int> dst_;
+	std::vector<int> cost_;		// LINK_DOWN if down
+	// links by destination, as indices into the above
+	std::vector<int> inStart_;
+	std::vector<int> inLink_;
+	// links changed since the last computation, with their new cost
+	std::vector<std::pair<int, int> > changed_;
+
+	std::vector<int> dist_;
+	std::vector<std::vector<int> > nextHops_;
+	std::vector<char> affected_;
+	std::vector<int> heap_;
+	std::vector<int> heapPos_;	// -1 if not in heap_
+	std::vector<int> heapKey_;
+};
+
 /* 
    LsMessage 
 */
@@ -572,7 +637,8 @@ public:
 	LsRouting() : myNodePtr_(NULL),  myNodeId_(LS_INVALID_NODE_ID), 
 		peerIdListPtr_(NULL), linkStateListPtr_(NULL),
 		routingTablePtr_(NULL),
-		linkStateDatabase_(), lsaHistory_(), ackManager_(*this) {}
+		linkStateDatabase_(), lsaHistory_(), ackManager_(*this),
+		fastSpf_(false) {}
 	~LsRouting() {
 		//delete pLinkStateDatabase;
 		if (routingTablePtr_ != NULL)
@@ -580,15 +646,14 @@ public:
 	}
 
 	bool init(LsNode* nodePtr);
-	void computeRoutes() {
-	        if (routingTablePtr_ != NULL)
-	                delete routingTablePtr_;
-	        routingTablePtr_ = _computeRoutes();
-	}
+	void setFastSpf(bool fastSpf) { fastSpf_ = fastSpf; }
+	// nodeId: the only node whose link states changed, if known
+	void computeRoutes(int nodeId = LS_INVALID_NODE_ID);
 	LsEqualPaths* lookup(int destId) {
-		return (routingTablePtr_ == NULL) ? 
-			(LsEqualPaths *)NULL : 
-			routingTablePtr_->findPtr(destId);
+		if (routingTablePtr_ == NULL)
+			return (fastSpf_ && spf_.lookup(destId, spfPaths_)) ?
+				&spfPaths_ : (LsEqualPaths *)NULL;
+		return routingTablePtr_->findPtr(destId);
 	}
 
 	// to propogate LSA, all Links, called by node and self
@@ -622,6 +687,10 @@ private:
 	typedef LsList<IdMsgPtr> MessageBuffer;
 	MessageBuffer messageBuffer_;
 
+	bool fastSpf_; // use spf_ instead of _computeRoutes
+	LsSpf spf_;
+	LsEqualPaths spfPaths_; // returned by lookup
+
 private:
 	LsMessageCenter& msgctr() { return LsMessageCenter::instance(); }
 	LsPaths* _computeRoutes();
@@ -252,6 +252,7 @@ void rtProtoLS::initialize() // init nodeState_ and routing_
 
 	// call routing.init(this); and computeRoutes
 	routing_.init(this);
+	routing_.setFastSpf(fastSpf_ != 0);
 	routing_.computeRoutes();
 	// debug
 	tcl.evalf("%s set LS_ready", name());
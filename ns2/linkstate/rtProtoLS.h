@@ -75,6 +75,7 @@ class rtProtoLS : public Agent , public LsNode {
 public:
         rtProtoLS() : Agent(PT_RTPROTO_LS) { 
 		LS_ready_ = 0;
+		bind("fast_spf_", &fastSpf_);
 	}
         int command(int argc, const char*const* argv);
         void sendpkt(ns_addr_t dst, u_int32_t z, u_int32_t mtvar);
@@ -111,6 +112,7 @@ private:
 	int nodeId_;
 	int LS_ready_;	// to differentiate fake and real LS, debug, 0 == no
 			// needed in recv and sendMessage;
+	int fastSpf_;	// compute paths with LsSpf
 
 	LsLinkStateList linkStateList_;
 	LsNodeIdList peerIdList_;
@@ -143,7 +143,10 @@ void DropTail::enque(Packet* p)
     pre_enque();
 
     if (will_overflow(p)) {
-	    drop(handle_overflow(p));
+        auto const victim = handle_overflow(p);
+        if (!trim_.try_trim(victim)) {
+            drop(victim);
+        }
 	} else {
 	    q_->enque(p);
 	}
@@ -186,7 +189,12 @@ Packet* DropTail::deque()
         Queue::updateStats(qib_ ? q_->byteLength() : q_->length());
     }
 
-    Packet * packet = nullptr;
+    // trimmed headers overtake all data
+    Packet * packet = trim_.deque();
+    if (packet != nullptr) {
+        return packet;
+    }
+
     if (deque_prio_) {
         packet = deque_priority();
 	} else if (drop_smart_) {
@@ -398,6 +406,9 @@ DropTail::DropTail()
     bind_bool("ecn_enable_", &ecn_enable_);
     bind_bool("drop_low_prio_", &drop_low_prio_);
     bind("good_limit_", &good_prio_qlim_);
+    bind_bool("trim_", &trim_.enabled_);
+    bind("trim_limit_", &trim_.limit_);
+    bind("trim_header_size_", &trim_.header_size_);
     bind("mean_pktsize_", &mean_pktsize_);
     bind("sq_limit_", &sq_limit_);
     bind("thresh_", &thresh_);
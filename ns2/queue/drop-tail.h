@@ -46,6 +46,7 @@ using std::queue;
 #include <memory>
 #include <string>
 #include "queue.h"
+#include "trim.h"
 #include "config.h"
 
 typedef struct flowkey {
@@ -75,6 +76,13 @@ public:
 
 	Packet* deque() override;
 
+	void recv_batch(Packet** p, int n) override { recv_each(p, n); }
+
+	// the trimmed headers waiting in trim_ occupy the port too
+	int int_backlog_bytes() override {
+		return Queue::int_backlog_bytes() + trim_.byte_length();
+	}
+
     ~DropTail() override;
 
 protected:
@@ -135,6 +143,8 @@ private:
 	unsigned int sq_limit_;
     std::unordered_map<size_t, int> sq_counts_;
 	std::queue<size_t> sq_queue_;
+
+    TrimmedHeaderLane trim_;
 };
 
 #endif
@@ -57,6 +57,10 @@ void Priority::enque(Packet* p)
 
 Packet* Priority::deque()
 {
+    if (auto header = trim_.deque()) {
+        return header;
+    }
+
     if(TotalByteLength()>0)
 	{
         //high->low: 0->7
@@ -84,6 +88,9 @@ Priority::Priority() {
     bind("thresh_",&thresh_);
     bind("mean_pktsize_", &mean_pktsize_);
     bind("marking_scheme_", reinterpret_cast<int *>(&marking_scheme_));
+    bind_bool("trim_", &trim_.enabled_);
+    bind("trim_limit_", &trim_.limit_);
+    bind("trim_header_size_", &trim_.header_size_);
 
     //Init queues
     for(int i=0;i<MAX_QUEUE_NUM;i++)
@@ -93,7 +100,9 @@ Priority::Priority() {
 }
  
 void Priority::handle_overflow(Packet * packet) {
-    drop(packet);
+    if (!trim_.try_trim(packet)) {
+        drop(packet);
+    }
 }
 
 int Priority::TotalByteLength() {
@@ -103,6 +112,10 @@ int Priority::TotalByteLength() {
     return bytelength;
 }
 
+int Priority::int_backlog_bytes() {
+    return TotalByteLength() + trim_.byte_length();
+}
+
 int Priority::get_priority(Packet *packet) const {
     return clamp_priority(hdr_ip::access(packet)->prio());
 }
@@ -12,6 +12,7 @@
 #define ns_priority_h
 
 #include "queue.h"
+#include "trim.h"
 #include "config.h"
 #include <memory>
 
@@ -30,6 +31,8 @@ class Priority : public Queue {
 
         void enque(Packet * packet) override;
         auto deque() -> Packet * override;
+        void recv_batch(Packet ** packets, int n) override { recv_each(packets, n); }
+        int int_backlog_bytes() override;
 
     protected:
         virtual void handle_overflow(Packet * packet);
@@ -43,6 +46,7 @@ class Priority : public Queue {
         int thresh_;            // single ECN marking threshold
         int queue_num_;         // number of CoS queues. No more than MAX_QUEUE_NUM
         ECNMode marking_scheme_;    // Disable ECN (0), Per-queue ECN (1) and Per-port ECN (2)
+        TrimmedHeaderLane trim_;    // headers of trimmed packets, served first
 
 
         //Return total queue length (bytes) of all the queues
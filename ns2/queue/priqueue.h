@@ -58,6 +58,7 @@ public:
 
         int     command(int argc, const char*const* argv);
         void    recv(Packet *p, Handler *h);
+        void    recv_batch(Packet **p, int n) { NsObject::recv_batch(p, n); }
 
         void    recvHighPriority(Packet *, Handler *);
         // insert packet at front of queue
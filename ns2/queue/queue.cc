@@ -40,6 +40,7 @@ static const char rcsid[] =
 #include <math.h>
 #include <stdio.h>
 #include <link/delay.h>
+#include "telemetry.h"
 
 void PacketQueue::remove(Packet* target)
 {
@@ -92,7 +93,7 @@ Queue::Queue() : Connector(), blocked_(0), unblock_on_resume_(1), qh_(*this),
 		 pq_(0), 
 		 last_change_(0), /* temporarily NULL */
 		 old_util_(0), period_begin_(0), cur_util_(0), buf_slot_(0),
-		 util_buf_(NULL)
+		 util_buf_(NULL), tx_bytes_(0), int_rate_(0)
 {
 	bind("limit_", &qlim_);
 	bind("util_weight_", &util_weight_);
@@ -100,6 +101,7 @@ Queue::Queue() : Connector(), blocked_(0), unblock_on_resume_(1), qh_(*this),
 	bind_bool("unblock_on_resume_", &unblock_on_resume_);
 	bind("util_check_intv_", &util_check_intv_);
 	bind("util_records_", &util_records_);
+	bind_bool("int_enabled_", &int_enabled_);
 
 	if (util_records_ > 0) {
 		util_buf_ = new double[util_records_];
@@ -129,11 +131,24 @@ void Queue::recv(Packet* p, Handler*)
 			utilUpdate(last_change_, now, blocked_);
 			last_change_ = now;
 			blocked_ = 1;
+			stamp_int(p);
 			target_->recv(p, &qh_);
 		}
 	}
 }
 
+/*
+ * Queue::recv for each packet, without going through the virtual recv
+ * every time.  Each packet is still enqueued and the link restarted
+ * before the next one is enqueued, so drops, marks and the order on
+ * the wire are the same as for separate arrivals.
+ */
+void Queue::recv_each(Packet** p, int n)
+{
+	for (int i = 0; i < n; ++i)
+		Queue::recv(p[i], 0);
+}
+
 void Queue::utilUpdate(double int_begin, double int_end, int link_state) {
 double decay;
 
@@ -212,7 +227,8 @@ void Queue::resume()
 	double now = Scheduler::instance().clock();
 	Packet* p = deque();
 	if (p != 0) {
-        p->owner_ = target_;
+		stamp_int(p);
+		p->owner_ = target_;
 		target_->recv(p, &qh_);
 	} else {
 		if (unblock_on_resume_) {
@@ -244,3 +260,43 @@ double Queue::get_link_bandwidth() const {
 }
 
 
+/*
+ * INT: record this hop in packets whose sender asked for telemetry.
+ * The byte counter only runs while INT is enabled, which is all the
+ * receiver needs since it only looks at differences between two records.
+ */
+void Queue::stamp_int(Packet* p)
+{
+	if (!int_enabled_)
+		return;
+	tx_bytes_ += hdr_cmn::access(p)->size();
+
+	auto const ih = hdr_int::access(p);
+	if (!ih->collect_)
+		return;
+	ih->push(IntHop{
+		Scheduler::instance().clock(),
+		int_link_rate(),
+		tx_bytes_,
+		int_backlog_bytes()
+	});
+}
+
+/*
+ * Unlike get_link_bandwidth, tolerate traces or other connectors between
+ * the queue and the link.
+ */
+double Queue::int_link_rate()
+{
+	if (int_rate_ > 0)
+		return int_rate_;
+	for (auto obj = target_; obj; ) {
+		if (auto link = dynamic_cast<LinkDelay*>(obj)) {
+			int_rate_ = link->bandwidth();
+			break;
+		}
+		auto conn = dynamic_cast<Connector*>(obj);
+		obj = conn ? conn->target() : nullptr;
+	}
+	return int_rate_;
+}
@@ -125,6 +125,8 @@ public:
     virtual void enque(Packet*) = 0;
 	virtual Packet* deque() = 0;
 	virtual void recv(Packet*, Handler*);
+	bool batchable() const { return true; }
+	void handle_batch(Event** e, int n) { handle_packets(e, n); }
 	virtual void updateStats(int queuesize); 
 	void resume();
 	
@@ -144,11 +146,18 @@ public:
 	double peak_utilization();
 	double get_link_bandwidth() const;
 
+	/* bytes waiting behind the packet being sent, reported by INT */
+	virtual int int_backlog_bytes() { return pq_ ? pq_->byteLength() : 0; }
+
 	virtual ~Queue();
 
 protected:
 	Queue();
 	void reset();
+	// recv_batch for disciplines that don't override recv
+	void recv_each(Packet** p, int n);
+	void stamp_int(Packet*);
+	double int_link_rate();
 	int qlim_;		/* maximum allowed pkts in queue */
 	int blocked_;		/* blocked now? */
 	int unblock_on_resume_;	/* unblock q on idle? */
@@ -175,6 +184,10 @@ protected:
 				   stored in memory. One slot in buffer holds
 				   period of util_check_intv_ seconds. */
 	// measuring #drops
+
+	int int_enabled_;	/* append an INT hop record on egress */
+	double tx_bytes_;	/* bytes sent so far, reported by INT */
+	double int_rate_;	/* cached link rate, 0 until looked up */
 	
 };
 
@@ -143,6 +143,7 @@ class REDQueue : public Queue {
  public:	
 	/*	REDQueue();*/
 	REDQueue(const char * = "Drop");
+	void recv_batch(Packet** p, int n) { recv_each(p, n); }
  protected:
 	void initParams();
 	int command(int argc, const char*const* argv);
@@ -0,0 +1,26 @@
+#include "trim.h"
+#include "flags.h"
+
+TrimmedHeaderLane::TrimmedHeaderLane()
+    : enabled_{0},
+      limit_{0},
+      header_size_{40},
+      lane_{} {
+}
+
+auto TrimmedHeaderLane::try_trim(Packet * packet) -> bool {
+    if (!enabled_ || lane_.length() >= limit_) {
+        return false;
+    }
+
+    auto const fh = hdr_flags::access(packet);
+    auto const ch = hdr_cmn::access(packet);
+    if (!fh->trimmable_ || fh->trimmed_ || ch->size() <= header_size_) {
+        return false;
+    }
+
+    ch->size() = header_size_;
+    fh->trimmed_ = 1;
+    lane_.enque(packet);
+    return true;
+}
@@ -0,0 +1,37 @@
+#ifndef ns_trim_h
+#define ns_trim_h
+
+#include "queue.h"
+
+/*
+ * Packet trimming (NDP/cut-payload style).
+ *
+ * Instead of dropping an overflowing packet, a queue may cut its payload
+ * and keep the header in a small lane that is served before any data.
+ * Only packets whose sender marked them trimmable (hdr_flags::trimmable_)
+ * are cut: other transports would misread a header-only segment.
+ */
+class TrimmedHeaderLane {
+public:
+    TrimmedHeaderLane();
+
+    /*
+     * Returns true if the packet was trimmed and queued in the lane, in
+     * which case the caller must not drop it.
+     */
+    auto try_trim(Packet * packet) -> bool;
+
+    auto deque() -> Packet * { return lane_.deque(); }
+    auto length() const -> int { return lane_.length(); }
+    auto byte_length() const -> int { return lane_.byteLength(); }
+
+public:
+    int enabled_;       // bool: trim instead of dropping
+    int limit_;         // headers the lane can hold
+    int header_size_;   // bytes left after trimming
+
+private:
+    PacketQueue lane_;
+};
+
+#endif
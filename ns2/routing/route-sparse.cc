@@ -0,0 +1,335 @@
+#include "route-sparse.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <sched.h>
+
+namespace {
+
+constexpr auto UNREACHABLE = std::numeric_limits<double>::infinity();
+constexpr std::size_t MAX_SETS = std::numeric_limits<std::uint16_t>::max() + 1;
+
+/*
+ * Cores this process may run on: a run pinned with taskset gets one,
+ * however many the machine has.
+ */
+auto usable_cores() -> int {
+#ifdef __linux__
+    cpu_set_t cpus;
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0) {
+        return std::max(1, CPU_COUNT(&cpus));
+    }
+#endif
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+}
+
+/*
+ * Per-thread scratch space.  The next hops of each node during a run are
+ * a bitset over the source's links, `words` 64-bit words per node.
+ */
+class SparseRoutes::Workspace {
+public:
+    explicit Workspace(int n) : dist(n), next_hops{}, words{0}, order{} {
+        order.reserve(n);
+    }
+
+    void start(std::size_t degree) {
+        words = (degree + 63) / 64;
+        std::fill(begin(dist), end(dist), UNREACHABLE);
+        next_hops.assign(dist.size() * words, 0);
+        order.clear();
+    }
+
+    auto bits(int node) -> std::uint64_t* { return &next_hops[node * words]; }
+
+    void set(int node, std::uint64_t const* from) {
+        std::copy(from, from + words, bits(node));
+    }
+
+    void merge(int node, std::uint64_t const* from) {
+        auto* to = bits(node);
+        for (std::size_t i = 0; i < words; ++i) {
+            to[i] |= from[i];
+        }
+    }
+
+    std::vector<double> dist;
+    std::vector<std::uint64_t> next_hops;
+    std::size_t words;
+    std::vector<int> order;     // nodes in the order they were settled
+};
+
+void SparseRoutes::insert(int src, int dst, double cost) {
+    auto const n = static_cast<std::size_t>(std::max(src, dst)) + 1;
+    if (adj_.size() < n) {
+        adj_.resize(n);
+    }
+    routes_.clear();
+
+    auto& edges = adj_[src];
+    auto const it = std::find_if(begin(edges), end(edges),
+            [dst] (auto const& e) { return e.dst == dst; });
+    if (it != end(edges)) {
+        it->cost = cost;
+    } else {
+        edges.push_back(Edge{dst, cost});
+    }
+}
+
+void SparseRoutes::reset(int src, int dst) {
+    if (src >= size()) {
+        return;
+    }
+    routes_.clear();
+    auto& edges = adj_[src];
+    edges.erase(std::remove_if(begin(edges), end(edges),
+                [dst] (auto const& e) { return e.dst == dst; }),
+            end(edges));
+}
+
+void SparseRoutes::clear() {
+    adj_.clear();
+    routes_.clear();
+}
+
+void SparseRoutes::compute(int threads) {
+    auto const n = size();
+    routes_.assign(n, NodeRoutes{});
+
+    // BFS is enough when every link costs the same
+    auto unit_costs = true;
+    auto cost = std::optional<double>{};
+    for (auto const& edges : adj_) {
+        for (auto const& e : edges) {
+            if (e.cost <= 0 || (cost && e.cost != *cost)) {
+                unit_costs = false;
+            }
+            cost = e.cost;
+        }
+    }
+
+    if (threads <= 0) {
+        threads = usable_cores();
+    }
+    threads = std::min(threads, std::max(n, 1));
+
+    std::atomic<int> next_source{0};
+    std::exception_ptr error{};
+    std::mutex error_mutex{};
+    auto const work = [&] {
+        Workspace ws{n};
+        try {
+            for (auto src = next_source++; src < n; src = next_source++) {
+                compute_source(src, unit_costs, ws);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock{error_mutex};
+            error = std::current_exception();
+            next_source = n;
+        }
+    };
+
+    auto pool = std::vector<std::thread>{};
+    for (auto i = 1; i < threads; ++i) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto& t : pool) {
+        t.join();
+    }
+
+    if (error) {
+        routes_.clear();
+        std::rethrow_exception(error);
+    }
+}
+
+void SparseRoutes::compute_source(int src, bool unit_costs, Workspace& ws) {
+    auto const& links = adj_[src];
+    ws.start(links.size());
+    ws.dist[src] = 0;
+    ws.order.push_back(src);
+
+    // the first hops seed the bitsets, one bit per link of src
+    auto const relax = [&] (int from, Edge const& e, auto&& push) {
+        auto const d = ws.dist[from] + e.cost;
+        if (d < ws.dist[e.dst]) {
+            ws.dist[e.dst] = d;
+            if (from == src) {
+                std::fill(ws.bits(e.dst), ws.bits(e.dst) + ws.words, 0);
+            } else {
+                ws.set(e.dst, ws.bits(from));
+            }
+            push(e.dst, d);
+        } else if (d == ws.dist[e.dst] && from != src) {
+            ws.merge(e.dst, ws.bits(from));
+        }
+        if (from == src && d == ws.dist[e.dst]) {
+            auto const bit = &e - links.data();
+            ws.bits(e.dst)[bit / 64] |= std::uint64_t{1} << (bit % 64);
+        }
+    };
+
+    if (unit_costs) {
+        auto head = std::size_t{0};
+        auto const push = [&] (int node, double) { ws.order.push_back(node); };
+        while (head < ws.order.size()) {
+            auto const u = ws.order[head++];
+            for (auto const& e : adj_[u]) {
+                relax(u, e, push);
+            }
+        }
+    } else {
+        using Item = std::pair<double, int>;
+        std::priority_queue<Item, std::vector<Item>, std::greater<>> heap{};
+        auto const push = [&] (int node, double d) { heap.emplace(d, node); };
+        for (auto const& e : links) {
+            relax(src, e, push);
+        }
+        while (!heap.empty()) {
+            auto const [d, u] = heap.top();
+            heap.pop();
+            if (d > ws.dist[u]) {
+                continue;       // stale entry
+            }
+            ws.order.push_back(u);
+            for (auto const& e : adj_[u]) {
+                relax(u, e, push);
+            }
+        }
+    }
+
+    // deduplicate the next hop sets of the destinations
+    auto& routes = routes_[src];
+    routes.self = {src};
+    routes.sets.emplace_back();
+    auto const n = size();
+    auto set_of = std::vector<std::uint16_t>(n, 0);
+    auto index = std::map<std::vector<std::uint64_t>, std::uint16_t>{};
+    auto key = std::vector<std::uint64_t>(ws.words);
+    auto last = std::uint16_t{0};
+    for (auto dst = 0; dst < n; ++dst) {
+        if (dst == src || ws.dist[dst] == UNREACHABLE) {
+            continue;
+        }
+        // neighbouring destinations mostly share their set
+        if (last != 0 && std::equal(begin(key), end(key), ws.bits(dst))) {
+            set_of[dst] = last;
+            continue;
+        }
+        std::copy(ws.bits(dst), ws.bits(dst) + ws.words, begin(key));
+        auto const [it, added] = index.emplace(key, routes.sets.size());
+        if (added) {
+            if (routes.sets.size() == MAX_SETS) {
+                throw std::runtime_error("too many next hop sets at a node");
+            }
+            auto hops = std::vector<int>{};
+            for (std::size_t bit = 0; bit < links.size(); ++bit) {
+                if (key[bit / 64] >> (bit % 64) & 1) {
+                    hops.push_back(links[bit].dst);
+                }
+            }
+            std::sort(begin(hops), end(hops));
+            routes.sets.push_back(std::move(hops));
+        }
+        set_of[dst] = last = it->second;
+    }
+
+    auto const uniform = routes.sets.size() == 2
+        && std::count(begin(set_of), end(set_of), 0) == 1;
+    if (!uniform) {
+        routes.set_of = std::move(set_of);
+    }
+}
+
+auto SparseRoutes::next_hops(int src, int dst) const -> std::vector<int> const& {
+    auto const& routes = routes_[src];
+    if (src == dst) {
+        return routes.self;
+    }
+    if (routes.set_of.empty()) {
+        return routes.sets.size() > 1 ? routes.sets[1] : routes.sets[0];
+    }
+    return routes.sets[routes.set_of[dst]];
+}
+
+auto SparseRoutes::next_hop(int src, int dst) const -> int {
+    auto const& hops = next_hops(src, dst);
+    return hops.empty() ? -1 : hops.front();
+}
+
+auto SparseRoutes::distances(int src) const -> std::vector<double> {
+    auto dist = std::vector<double>(size(), UNREACHABLE);
+    using Item = std::pair<double, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<>> heap{};
+    dist[src] = 0;
+    heap.emplace(0, src);
+    while (!heap.empty()) {
+        auto const [d, u] = heap.top();
+        heap.pop();
+        if (d > dist[u]) {
+            continue;
+        }
+        for (auto const& e : adj_[u]) {
+            if (d + e.cost < dist[e.dst]) {
+                dist[e.dst] = d + e.cost;
+                heap.emplace(dist[e.dst], e.dst);
+            }
+        }
+    }
+    return dist;
+}
+
+auto SparseRoutes::loop_free_alternates(int src) const
+        -> std::vector<std::vector<int>> {
+    auto const n = size();
+    auto alternates = std::vector<std::vector<int>>(n);
+    if (adj_[src].size() < 2) {
+        return alternates;
+    }
+
+    // a neighbour whose only link is back to src (a host) never qualifies
+    auto neighbours = std::vector<int>{};
+    for (auto const& e : adj_[src]) {
+        auto const& out = adj_[e.dst];
+        if (std::any_of(begin(out), end(out),
+                    [src] (auto const& f) { return f.dst != src; })) {
+            neighbours.push_back(e.dst);
+        }
+    }
+    if (neighbours.empty()) {
+        return alternates;
+    }
+    std::sort(begin(neighbours), end(neighbours));
+
+    auto const from_src = distances(src);
+    for (auto const nb : neighbours) {
+        auto const from_nb = distances(nb);
+        for (auto dst = 0; dst < n; ++dst) {
+            if (dst == src || from_src[dst] == UNREACHABLE) {
+                continue;
+            }
+            if (!(from_nb[dst] < from_nb[src] + from_src[dst])) {
+                continue;
+            }
+            auto const& primary = next_hops(src, dst);
+            if (!std::binary_search(begin(primary), end(primary), nb)) {
+                alternates[dst].push_back(nb);
+            }
+        }
+    }
+    return alternates;
+}
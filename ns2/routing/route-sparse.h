@@ -0,0 +1,88 @@
+#ifndef ns_route_sparse_h
+#define ns_route_sparse_h
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * All-pairs shortest paths over adjacency lists, for topologies too
+ * large for RouteLogic's n x n matrices.  Each source is solved
+ * separately, by BFS when all link costs are equal and by Dijkstra with
+ * a binary heap otherwise, on a pool of threads.
+ *
+ * Every equal-cost next hop is kept.  The routes of a node are stored as
+ * its distinct next hop sets plus the set of each destination; a node
+ * reaching every destination through the same set (a host behind its
+ * ToR) stores just that set, so memory stays far below n x n for
+ * fabrics of hosts.
+ *
+ * Nodes are numbered from 0.
+ */
+class SparseRoutes {
+public:
+    /*
+     * Sets the cost of the link src -> dst, adding it if needed.
+     */
+    void insert(int src, int dst, double cost);
+    /*
+     * Removes the link src -> dst, if any.
+     */
+    void reset(int src, int dst);
+    void clear();
+
+    /*
+     * Computes the routes of all nodes with `threads` threads (0: one
+     * per core the process may run on).  Throws std::runtime_error if a node has
+     * more distinct next hop sets than can be indexed.
+     */
+    void compute(int threads);
+
+    [[nodiscard]] auto computed() const -> bool { return !routes_.empty(); }
+    [[nodiscard]] auto size() const -> int { return static_cast<int>(adj_.size()); }
+
+    /*
+     * Equal-cost next hops from src to dst in increasing order: empty if
+     * dst is unreachable, {src} if dst == src.  Both must be < size().
+     */
+    [[nodiscard]] auto next_hops(int src, int dst) const -> std::vector<int> const&;
+
+    /*
+     * Lowest-numbered next hop from src to dst, -1 if unreachable.
+     */
+    [[nodiscard]] auto next_hop(int src, int dst) const -> int;
+
+    /*
+     * Loop-free alternates of src (RFC 5286), per destination: the
+     * neighbours of src other than its equal-cost next hops whose own
+     * shortest path does not lead back through src, in increasing
+     * order.  Computed on demand, one shortest path run per neighbour,
+     * from the links as of the last compute().
+     */
+    [[nodiscard]] auto loop_free_alternates(int src) const
+            -> std::vector<std::vector<int>>;
+
+private:
+    struct Edge {
+        int dst;
+        double cost;
+    };
+
+    struct NodeRoutes {
+        std::vector<int> self;
+        // sets[0] is the empty set of unreachable destinations
+        std::vector<std::vector<int>> sets;
+        // set index per destination; empty when all other nodes use sets[1]
+        std::vector<std::uint16_t> set_of;
+    };
+
+    class Workspace;
+
+    void compute_source(int src, bool unit_costs, Workspace& ws);
+    [[nodiscard]] auto distances(int src) const -> std::vector<double>;
+
+private:
+    std::vector<std::vector<Edge>> adj_;
+    std::vector<NodeRoutes> routes_;
+};
+
+#endif
@@ -43,6 +43,8 @@ static const char rcsid[] =
 
 #include <stdlib.h>
 #include <assert.h>
+#include <stdexcept>
+#include <string>
 #include "config.h"
 #include "route.h"
 #include "address.h"
@@ -57,6 +59,7 @@ public:
 
 void RouteLogic::reset_all()
 {
+	sparse_routes_.clear();
 	delete[] adj_;
 	delete[] route_;
 	adj_ = 0; 
@@ -69,6 +72,15 @@ int RouteLogic::command(int argc, const char*const* argv)
 	Tcl& tcl = Tcl::instance();
 	if (argc == 2) {
 		if (strcmp(argv[1], "compute") == 0) {
+			if (sparse_) {
+				try {
+					sparse_routes_.compute(threads_);
+				} catch (std::runtime_error const& e) {
+					tcl.resultf("compute: %s", e.what());
+					return (TCL_ERROR);
+				}
+				return (TCL_OK);
+			}
 			if (adj_ == 0)
 				return (TCL_OK);
 			compute_routes();
@@ -98,7 +110,10 @@ int RouteLogic::command(int argc, const char*const* argv)
 				return (TCL_ERROR);
 			}
 			double cost = (argc == 5 ? atof(argv[4]) : 1);
-			insert(src, dst, cost);
+			if (sparse_)
+				sparse_routes_.insert(src - 1, dst - 1, cost);
+			else
+				insert(src, dst, cost);
 			return (TCL_OK);
 		} else if (strcmp(argv[1], "hlevel-is") == 0) {
 			level_ = atoi(argv[2]);
@@ -186,7 +201,10 @@ int RouteLogic::command(int argc, const char*const* argv)
 				tcl.result("negative node number");
 				return (TCL_ERROR);
 			}
-			reset(src, dst);
+			if (sparse_)
+				sparse_routes_.reset(src - 1, dst - 1);
+			else
+				reset(src, dst);
 			return (TCL_OK);
 		} else if (strcmp(argv[1], "lookup") == 0) {
 			int nh;
@@ -195,6 +213,38 @@ int RouteLogic::command(int argc, const char*const* argv)
 			if (res == TCL_OK)
 				tcl.resultf("%d", nh);
 			return res;
+		} else if (strcmp(argv[1], "lookup-all") == 0) {
+			/*
+			 * $routelogic lookup-all $src $dst: all equal-cost
+			 * next hops, only kept with sparse_
+			 */
+			if (!sparse_) {
+				int nh;
+				int res = lookup_flat((char*)argv[2],
+				    (char*)argv[3], nh);
+				if (res == TCL_OK)
+					tcl.resultf("%d", nh);
+				return res;
+			}
+			int src = atoi(argv[2]);
+			int dst = atoi(argv[3]);
+			if (!sparse_routes_.computed()) {
+				tcl.result("routes not yet computed");
+				return (TCL_ERROR);
+			}
+			if (src < 0 || dst < 0 || src >= sparse_routes_.size() ||
+			    dst >= sparse_routes_.size()) {
+				tcl.result("node out of range");
+				return (TCL_ERROR);
+			}
+			std::string hops;
+			for (int nh : sparse_routes_.next_hops(src, dst)) {
+				if (!hops.empty())
+					hops += ' ';
+				hops += std::to_string(nh);
+			}
+			tcl.result(hops.c_str());
+			return (TCL_OK);
 		}
 	}
 	return (TclObject::command(argc, argv));
@@ -206,6 +256,19 @@ int RouteLogic::lookup_flat(char* asrc, char* adst, int& result) {
 	int src = atoi(asrc) + 1;
 	int dst = atoi(adst) + 1;
 
+	if (sparse_) {
+		if (!sparse_routes_.computed()) {
+			tcl.result("routes not yet computed");
+			return (TCL_ERROR);
+		}
+		if (src <= 0 || dst <= 0 || src > sparse_routes_.size() ||
+		    dst > sparse_routes_.size()) {
+			tcl.result("node out of range");
+			return (TCL_ERROR);
+		}
+		result = sparse_routes_.next_hop(src - 1, dst - 1);
+		return TCL_OK;
+	}
 	if (route_ == 0) {
 		// routes are computed only after the simulator is running
 		// ($ns run).
@@ -225,6 +288,18 @@ int RouteLogic::lookup_flat(char* asrc, char* adst, int& result) {
 int RouteLogic::lookup_flat(int sid, int did) {
 	int src = sid+1;
 	int dst = did+1;
+	if (sparse_) {
+		if (!sparse_routes_.computed()) {
+			printf("routes not yet computed\n");
+			return (-1);
+		}
+		if (sid < 0 || did < 0 || sid >= sparse_routes_.size() ||
+		    did >= sparse_routes_.size()) {
+			printf("node out of range\n");
+			return (-2);
+		}
+		return sparse_routes_.next_hop(sid, did);
+	}
 	if (route_ == 0) {
 		// routes are computed only after the simulator is running
 		// ($ns run).
@@ -313,6 +388,12 @@ RouteLogic::RouteLogic()
 	size_ = 0;
 	adj_ = 0;
 	route_ = 0;
+	sparse_ = 0;
+	threads_ = 0;
+	lfa_ = 0;
+	bind("sparse_", &sparse_);
+	bind("threads_", &threads_);
+	bind("lfa_", &lfa_);
 	/* additions for hierarchical routing extension */
 	C_ = 0;
 	D_ = 0;
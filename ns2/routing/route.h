@@ -43,6 +43,8 @@
 #ifndef ns_route_h
 #define ns_route_h
 
+#include "route-sparse.h"
+
 #undef INFINITY
 #define INFINITY	0x3fff
 #define INDEX(i, j, N) ((N) * (i) + (j))
@@ -83,6 +85,12 @@ public:
 	inline int domains(){ return (D_-1); }
 	inline int domain_size(int domain);
 	inline int cluster_size(int domain, int cluster);
+	// the sparse engine's routes, 0 unless sparse_
+	SparseRoutes const* sparse_routes() const {
+		return sparse_ ? &sparse_routes_ : 0;
+	}
+	// whether to install loop-free alternates with the sparse routes
+	int lfa() const { return lfa_; }
 protected:
 
 	void check(int);
@@ -97,6 +105,17 @@ protected:
 	int size_,
 		maxnode_;
 
+	/*
+	 * With sparse_, flat routes are kept by sparse_routes_ instead of
+	 * the n x n adj_ and route_, and computed with threads_ threads.
+	 * lfa_ asks Simulator populate-ecmp-classifiers for backup next
+	 * hops as well.
+	 */
+	int sparse_;
+	int threads_;
+	int lfa_;
+	SparseRoutes sparse_routes_;
+
 	/**** Hierarchical routing support ****/
 
 	void hier_check(int index);
@@ -75,6 +75,7 @@ if {[info commands CMUTrace] != ""} {
     CMUTrace set duration_scaling_factor_ 3.0e4
 }
 
+Scheduler set batch_ 1; # same-time events per handler dispatched together (max 64), 1: off
 Scheduler/RealTime set maxslop_ 0.010; # max allowed slop b4 error (sec)
 
 Scheduler/Calendar set adjust_new_width_interval_ 10;	# the interval (in unit of resize times) we recalculate bin width. 0 means disable dynamic adjustment
@@ -96,6 +97,7 @@ Queue set interleave_ false
 Queue set acksfirst_ false
 Queue set ackfromfront_ false
 Queue set debug_ false
+Queue set int_enabled_ false; # append INT records, see common/telemetry.h
 
 Queue/SFQ set maxqueue_ 40
 Queue/SFQ set buckets_ 16
@@ -123,6 +125,14 @@ Queue/DropTail set keep_order_ false
 Queue/DropTail set last_delay_controller_enabled_ false
 Queue/DropTail set expiration_time_controller_enabled_ false
 
+# Packet trimming: forward the header of overflowing packets (queue/trim.h)
+Queue/DropTail set trim_ false
+Queue/DropTail set trim_limit_ 64
+Queue/DropTail set trim_header_size_ 40
+Queue/Priority set trim_ false
+Queue/Priority set trim_limit_ 64
+Queue/Priority set trim_header_size_ 40
+
 # special cmu implemented priority queue used by DSR
 CMUPriQueue set qlen_logthresh_ 10
 CMUPriQueue set fw_logthresh_ 25
@@ -429,6 +439,9 @@ DelayLink set avoidReordering_ false ;	# Added 3/27/2003.
 DynamicLink set status_ 1
 DynamicLink set debug_ false
 
+# fold the TTL check into the delay stage and route straight to the queue
+SimpleLink set fast_ 0
+
 Filter set debug_ false
 Filter/Field set offset_ 0
 Filter/Field set match_  -1
@@ -460,6 +473,12 @@ Classifier/MultiPath set nodeid_ 0
 Classifier/MultiPath set nodetype_ 0
 Classifier/MultiPath set perflow_ 0
 Classifier/MultiPath set checkpathid_ 0
+Classifier/MultiPath set hash_seed_ 0
+Classifier/MultiPath set legacy_hash_ 0
+Classifier/MultiPath set flowlet_gap_ 0
+Classifier/MultiPath set flowlet_table_size_ 4096
+Classifier/MultiPath set congestion_aware_ 0
+MultiPathTelemetry set interval_ 0.001
 #
 # FEC models
 #
@@ -569,6 +588,19 @@ Application/Traffic/CBR set maxpkts_ 268435456; # 0x10000000
 
 Application/Telnet set interval_ 1.0
 
+Application/Chunks set streaming_schedule_ false	;# see apps/chunk-schedule.h
+
+TrafficMatrix set flow_limit_ 0
+TrafficMatrix set count_after_ 0.2	;# flows started earlier don't count towards flow_limit_
+TrafficMatrix set pool_ false
+TrafficMatrix set link_rate_ 10	;# Gbps, for the oracle FCT of flows sent at once
+TrafficMatrix set summary_interval_ 0	;# seconds between summaries, 0 for only the final one
+
+ConvergenceController set batch_size_ 500
+ConvergenceController set min_batches_ 10
+ConvergenceController set min_flows_ 10000
+ConvergenceController set precision_ 0.05	;# relative half-width of the 95% confidence intervals
+
 # Default config based on data for slammer worm
 Application/Worm set ScanRate 4000
 Application/Worm set ScanPort 1434
@@ -933,6 +965,7 @@ Agent set flags_ 0
 Agent set ttl_ 32 ; # arbitrary choice here
 Agent set debug_ false
 Agent set class_ 0
+Agent set flow_hash_ 0 ; # 0: derived from the addresses and fid_
 
 ##Agent set seqno_ 0 now is gone
 ##Agent set class_ 0 now is gone
@@ -1380,6 +1413,20 @@ if [TclObject is-class Agent/TCP/FullTcp] {
     Agent/TCP/FullTcp set use_true_remaining_size_ false;
 	Agent/TCP/FullTcp set use_deadline true;
 	Agent/TCP/FullTcp set afabric_ecn_enabled_ false;
+	Agent/TCP/FullTcp set hpcc_enabled_ false; # needs Queue int_enabled_
+	Agent/TCP/FullTcp set hpcc_eta_ 0.95; # target utilisation
+	Agent/TCP/FullTcp set hpcc_wai_ 0.2; # additive increase (packets)
+	Agent/TCP/FullTcp set hpcc_max_stage_ 5;
+	Agent/TCP/FullTcp set hpcc_base_rtt_ 0.0001; # seconds
+	Agent/TCP/FullTcp set swift_enabled_ false;
+	Agent/TCP/FullTcp set swift_base_target_ 0.00005; # seconds
+	Agent/TCP/FullTcp set swift_per_hop_ 0.000002; # seconds per link
+	Agent/TCP/FullTcp set swift_fs_range_ 0.00005; # flow scaling, seconds
+	Agent/TCP/FullTcp set swift_fs_min_cwnd_ 1;
+	Agent/TCP/FullTcp set swift_fs_max_cwnd_ 100;
+	Agent/TCP/FullTcp set swift_ai_ 1; # packets per RTT
+	Agent/TCP/FullTcp set swift_beta_ 0.8;
+	Agent/TCP/FullTcp set swift_max_mdf_ 0.5;
 
 	Agent/TCP/FullTcp/Newreno set recov_maxburst_ 2; # max burst dur recov
 
@@ -1420,6 +1467,46 @@ if [TclObject is-class Agent/TCP/FullTcp] {
 
 }
 
+if [TclObject is-class Agent/Homa] {
+	Agent/Homa set packetSize_ 1460; # payload bytes per DATA packet
+	Agent/Homa set header_size_ 40; # bytes added to every packet
+	Agent/Homa set rtt_bytes_ 14600; # unscheduled bytes per message
+	Agent/Homa set unsched_prio_ 0; # prio of unscheduled DATA
+	Agent/Homa set sched_prio_base_ 1; # prio of the top granted message
+	Agent/Homa set sched_prio_num_ 6; # scheduled prio levels
+	Agent/Homa set overcommit_ 2; # messages granted at once per receiver
+	Agent/Homa set rtx_timeout_ 0.002; # sender probe when receiver is silent
+	Agent/Homa set resend_timeout_ 0.0005; # receiver RESEND for holes
+	Agent/Homa set nrexmit_ 0
+	Agent/Homa set nominal_deadline 0
+	Agent/Homa set early_terminated_ 0
+	Agent/Homa set true_flow_size_ -1
+	Agent/Homa set flow_remaining_ -1
+	Agent/Homa set use_deadline false
+	Agent/Homa set enable_early_expiration_ false
+
+	Agent/Homa instproc done_data {} { }
+}
+
+if [TclObject is-class Agent/NDP] {
+	Agent/NDP set packetSize_ 1460
+	Agent/NDP set header_size_ 40
+	Agent/NDP set rtt_bytes_ 14600; # initial window sent before any PULL
+	Agent/NDP set unsched_prio_ 0
+	Agent/NDP set link_rate_ 10; # Gbps, paces the PULLs of a host
+	Agent/NDP set rtx_timeout_ 0.002
+	Agent/NDP set resend_timeout_ 0.0005
+	Agent/NDP set nrexmit_ 0
+	Agent/NDP set nominal_deadline 0
+	Agent/NDP set early_terminated_ 0
+	Agent/NDP set true_flow_size_ -1
+	Agent/NDP set flow_remaining_ -1
+	Agent/NDP set use_deadline false
+	Agent/NDP set enable_early_expiration_ false
+
+	Agent/NDP instproc done_data {} { }
+}
+
 if [TclObject is-class Agent/TCP/BayFullTcp] {
 	Agent/TCP/BayFullTcp set segsperack_ 1; # ACK frequency
 	Agent/TCP/BayFullTcp set segsize_ 536; # segment size
@@ -1507,6 +1594,11 @@ Agent/rtProto/DV set preference_	120
 Agent/rtProto/DV set INFINITY		 [Agent set ttl_]
 Agent/rtProto/DV set advertInterval	  2
 
+# Centralized (static) route computation
+RouteLogic set sparse_ 0		;# adjacency lists, all ECMP next hops
+RouteLogic set threads_ 0		;# threads for sparse_, 0: one per usable core
+RouteLogic set lfa_ 0			;# loop-free alternates with static ECMP
+
 Agent/Encapsulator set status_ 1
 Agent/Encapsulator set overhead_ 20
 
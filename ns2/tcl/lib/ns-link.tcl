@@ -168,12 +168,24 @@ Link instproc install-error {em} {
 
 Class SimpleLink -superclass Link
 
+#
+# With fast_ set, a plain DelayLink is replaced by a DelayLink/TTL that
+# checks the TTL itself, ttl_ naming the same object, and routes point
+# straight at the queue while nothing has been added to the head (see
+# SimpleLink head).  Multicast and source routing keep the full chain.
+#
 SimpleLink instproc init { src dst bw delay q {lltype "DelayLink"} } {
 	$self next $src $dst
 	$self instvar link_ queue_ head_ toNode_ ttl_
-	$self instvar drophead_
+	$self instvar drophead_ fast_
 
 	set ns [Simulator instance]
+	$ns instvar srcRt_
+	set fast_ [expr {[SimpleLink set fast_] && $lltype == "DelayLink" &&
+	    ![$ns multicast?] && !([info exists srcRt_] && $srcRt_ == 1)}]
+	if $fast_ {
+		set lltype DelayLink/TTL
+	}
 	set drophead_ [new Connector]
 	$drophead_ target [$ns set nullAgent_]
 
@@ -202,10 +214,14 @@ SimpleLink instproc init { src dst bw delay q {lltype "DelayLink"} } {
 	# for ttl-drops within the trace and/or monitor
 	# fabric
 	#
-	set ttl_ [new TTLChecker]
-	$ttl_ target [$link_ target]
+	if $fast_ {
+		set ttl_ $link_
+	} else {
+		set ttl_ [new TTLChecker]
+		$ttl_ target [$link_ target]
+		$link_ target $ttl_
+	}
 	$self ttl-drop-trace
-	$link_ target $ttl_
 
 	# Finally, if running a multicast simulation,
 	# put the iif for the neighbor node...
@@ -221,6 +237,24 @@ SimpleLink instproc init { src dst bw delay q {lltype "DelayLink"} } {
 
 }
 
+SimpleLink instproc head {} {
+	$self instvar head_ queue_ fast_ head_bypassed_
+	if {$fast_ && [$head_ target] == $queue_} {
+		set head_bypassed_ 1
+		return $queue_
+	}
+	return $head_
+}
+
+SimpleLink instproc add-to-head { connector } {
+	$self instvar head_bypassed_
+	if [info exists head_bypassed_] {
+		error "$self: cannot add $connector to the head of a fast link\
+		    once routes point at its queue (set SimpleLink fast_ 0)"
+	}
+	$self next $connector
+}
+
 SimpleLink instproc enable-src-rt {src dst head} {
     $self instvar ttl_
     $src instvar src_agent_
@@ -351,20 +351,7 @@ Node instproc add-routes {id ifs} {
 			# 2. migrate existing routes to that mclassifier
 			# 3. install the mclassifier in the node classifier_
 			#
-			set mpathClsfr_($id) [new Classifier/MultiPath]
-			$mpathClsfr_($id) set nodeid_ [$self id]
-			set nodecolor_ [$self get-attribute "COLOR"]
-			set nodetype_ 0
-			if {$nodecolor_ == "green"} {
-				set nodetype_ 1
-			}
-			if {$nodecolor_ == "blue"} {
-				set nodetype_ 2
-			}
-			if {$nodecolor_ == "red"} {
-				set nodetype_ 3
-			}
-			$mpathClsfr_($id) set nodetype_ $nodetype_
+			set mpathClsfr_($id) [$self new-mpath-classifier]
 			if {$routes_($id) > 0} {
 				assert "$routes_($id) == 1"
 				$mpathClsfr_($id) installNext \
@@ -373,12 +360,90 @@ Node instproc add-routes {id ifs} {
 			$classifier_ install $id $mpathClsfr_($id)
 		}
 		foreach L $ifs {
-			$mpathClsfr_($id) installNext [$L head]
+			set slot [$mpathClsfr_($id) installNext [$L head]]
+			$mpathClsfr_($id) next-hop $slot [[$L dst] id]
+			if {[$L info vars queue_] != ""} {
+				$mpathClsfr_($id) attach-queue $slot [$L queue]
+			}
 			incr routes_($id)
 		}
 	}
 }
 
+Node instproc new-mpath-classifier {} {
+	set mpath [new Classifier/MultiPath]
+	$mpath set nodeid_ [$self id]
+	set nodecolor_ [$self get-attribute "COLOR"]
+	set nodetype_ 0
+	if {$nodecolor_ == "green"} {
+		set nodetype_ 1
+	}
+	if {$nodecolor_ == "blue"} {
+		set nodetype_ 2
+	}
+	if {$nodecolor_ == "red"} {
+		set nodetype_ 3
+	}
+	$mpath set nodetype_ $nodetype_
+	return $mpath
+}
+
+# Whether the destinations reached through the same next hops can share
+# a multipath classifier.  Not with round robin spraying: its counter is
+# per classifier, and add-routes keeps one per destination.
+Node proc ecmp-shared? {} {
+	foreach var {perflow_ checkpathid_ congestion_aware_} {
+		if [Classifier/MultiPath set $var] {
+			return 1
+		}
+	}
+	expr [Classifier/MultiPath set flowlet_gap_] > 0
+}
+
+# Multipath classifier over the links to the next hops $nhs (node ids),
+# shared by all destinations reached through the same set, or just for
+# destination $dst if given (see ecmp-shared?); used by static ECMP
+# routing (Simulator compute-ecmp-routes).  The links to $backups are
+# installed as backup slots, only used while every link to $nhs is
+# down (see link-state).
+Node instproc ecmp-classifier {nhs {backups ""} {dst ""}} {
+	$self instvar ecmpClsfr_
+	set key [join $nhs :]/[join $backups :]/$dst
+	if ![info exists ecmpClsfr_($key)] {
+		set ns [Simulator instance]
+		set mpath [$self new-mpath-classifier]
+		foreach nh [concat $nhs $backups] {
+			set L [$ns link [$self id] $nh]
+			set slot [$mpath installNext [$L head]]
+			$mpath next-hop $slot $nh
+			if {[$L info vars queue_] != ""} {
+				$mpath attach-queue $slot [$L queue]
+			}
+			if {[lsearch -exact $backups $nh] >= 0} {
+				$mpath backup $slot
+			}
+		}
+		set ecmpClsfr_($key) $mpath
+	}
+	return $ecmpClsfr_($key)
+}
+
+# Tells the node's multipath classifiers that its link to node $nh went
+# $state (up or down), so that they stop or resume using it at once,
+# without waiting for new routes.  They share the link states of the
+# node, so telling one is enough.
+Node instproc link-state {nh state} {
+	$self instvar ecmpClsfr_ mpathClsfr_
+	foreach var {ecmpClsfr_ mpathClsfr_} {
+		if [array exists $var] {
+			foreach key [array names $var] {
+				[set ${var}($key)] link-state $nh $state
+				return
+			}
+		}
+	}
+}
+
 Node instproc delete-routes {id ifs nullagent} {
 	$self instvar mpathClsfr_ routes_
 	if [info exists mpathClsfr_($id)] {
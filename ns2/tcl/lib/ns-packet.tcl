@@ -184,6 +184,8 @@ set protolist {
         IPinIP 	# IP encapsulation 
 	HDLC 	# High Level Data Link Control
     Delay
+    RD 	# receiver-driven transports, tcp/rd-agent.cc
+    INT 	# in-band network telemetry, common/telemetry.h
 }
 set allhdrs [regsub -all {#.*?\n} $protolist \n]; # strip comments from above
 foreach prot $allhdrs {
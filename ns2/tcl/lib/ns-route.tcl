@@ -318,6 +318,63 @@ Simulator instproc compute-routes {} {
 	}
 }
 
+# Static routes over all equal-cost paths, computed by RouteLogic's
+# sparse engine and installed without routing agents (rtProto StaticECMP).
+Simulator instproc compute-ecmp-routes {} {
+	$self instvar link_
+	if [Simulator hier-addr?] {
+		error "static ECMP routing needs flat addressing"
+	}
+	set r [$self get-routelogic]
+	$self cmd get-routelogic $r  ;# propagate rl in C++
+	$r set sparse_ 1
+	$r reset
+	foreach ln [array names link_] {
+		set L [split $ln :]
+		if { [$link_($ln) up?] == "up" } {
+			$r insert [lindex $L 0] [lindex $L 1] [$link_($ln) cost?]
+		}
+	}
+	$r compute
+	$self populate-ecmp-classifiers [Node set nn_]
+}
+
+# Takes the links between nodes $n1 and $n2 down at time $at, and up
+# again at $recover_at unless empty.  The multipath classifiers at both
+# ends stop or resume using the links at once (Node link-state, fast
+# local reroute); the routes follow $reconverge seconds later, or never
+# if it is negative, and until then packets routed over the links by
+# other nodes, or by a single next hop, are dropped by them.  The links
+# are made dynamic here, so call before the routes are installed
+# ($ns run) if they are fast SimpleLinks.
+Simulator instproc fail-link {n1 n2 at {recover_at ""} {reconverge -1}} {
+	[$self link $n1 $n2] dynamic
+	[$self link $n2 $n1] dynamic
+	$self at $at "$self set-link-state $n1 $n2 down $reconverge"
+	if {$recover_at != ""} {
+		$self at $recover_at \
+			"$self set-link-state $n1 $n2 up $reconverge"
+	}
+}
+
+Simulator instproc set-link-state {n1 n2 state reconverge} {
+	foreach {from to} [list $n1 $n2 $n2 $n1] {
+		[$self link $from $to] $state
+		$from link-state [$to id] $state
+	}
+	if {$reconverge >= 0} {
+		$self at [expr [$self now] + $reconverge] \
+			"$self reconverge-routes $n1 $n2"
+	}
+}
+
+# Recomputes the routes after a link change, as rtModel notify does.
+Simulator instproc reconverge-routes {n1 n2} {
+	$n1 intf-changed
+	$n2 intf-changed
+	[$self get-routelogic] notify
+}
+
 Simulator instproc compute-flat-routes {} {
 	$self instvar Node_ link_
 	#
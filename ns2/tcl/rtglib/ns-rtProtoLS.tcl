@@ -65,6 +65,7 @@ Agent/rtProto/LS set UNREACHABLE  [rtObject set unreach_]
 Agent/rtProto/LS set preference_        120
 Agent/rtProto/LS set INFINITY           [Agent set ttl_]
 Agent/rtProto/LS set advertInterval     1800
+Agent/rtProto/LS set fast_spf_          0 ;# 1: flat arrays and incremental SPF (LsSpf)
 
 # like DV's, except $self cmd initialize and cmd setNodeNumber
 Agent/rtProto/LS proc init-all args {
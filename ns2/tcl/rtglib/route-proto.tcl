@@ -404,6 +404,21 @@ Agent/rtProto/Session proc compute-all {} {
     [Simulator instance] compute-routes
 }
 
+#
+# Static routing over all equal-cost paths: computed centrally and
+# installed straight into the node classifiers, without routing agents
+# or route messages.
+#
+Class Agent/rtProto/StaticECMP -superclass Agent/rtProto
+
+Agent/rtProto/StaticECMP proc init-all args {
+    [Simulator instance] compute-ecmp-routes
+}
+
+Agent/rtProto/StaticECMP proc compute-all {} {
+    [Simulator instance] compute-ecmp-routes
+}
+
 #
 #########################################################################
 #
@@ -2,6 +2,10 @@
 #include "ecn/senders.h"
 #include "tcp-full.h"
 
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
 AfabricEcnhatSenderCETracker::AfabricEcnhatSenderCETracker(
         FullTcpAgent::EcnProcessor * processor)
     : EcnhatSenderCETracker(processor) 
@@ -16,3 +20,254 @@ auto AfabricEcnhatSenderCETracker::is_ecn_active(Packet * pkt) const -> bool {
         && (!hdr_flags::access(pkt)->ecn_low_prio() || 
                 !agent().signal_on_empty_);
 }
+
+HpccSenderCETracker::HpccSenderCETracker(FullTcpAgent * agent)
+    : eta_{0.95}
+    , wai_{0.2}
+    , max_stage_{5}
+    , base_rtt_{0.0001}
+    , utilisation_{0}
+    , reference_window_{0}
+    , inc_stage_{0}
+    , last_update_seq_{0}
+    , maxseq_{0}
+    , nhops_{0}
+    , hops_{}
+    , agent_{agent}
+{}
+
+auto HpccSenderCETracker::agent() -> FullTcpAgent& {
+    return *agent_;
+}
+
+void HpccSenderCETracker::delay_bind_init_all() {
+    agent().delay_bind_init_one("hpcc_eta_");
+    agent().delay_bind_init_one("hpcc_wai_");
+    agent().delay_bind_init_one("hpcc_max_stage_");
+    agent().delay_bind_init_one("hpcc_base_rtt_");
+}
+
+auto HpccSenderCETracker::delay_bind_dispatch(
+        const char *varName, const char *localName, TclObject *tracer) -> bool {
+    if (agent().delay_bind(varName, localName, "hpcc_eta_", &eta_, tracer)) return true;
+    if (agent().delay_bind(varName, localName, "hpcc_wai_", &wai_, tracer)) return true;
+    if (agent().delay_bind(varName, localName, "hpcc_max_stage_", &max_stage_, tracer)) return true;
+    if (agent().delay_bind(varName, localName, "hpcc_base_rtt_", &base_rtt_, tracer)) return true;
+    return false;
+}
+
+void HpccSenderCETracker::on_foutput(int highest) {
+    if (highest > maxseq_)
+        maxseq_ = highest;
+}
+
+void HpccSenderCETracker::on_timeout() {
+    last_update_seq_ = agent().t_seqno_;
+    maxseq_ = last_update_seq_;
+}
+
+void HpccSenderCETracker::on_receive(Packet * pkt) {
+    auto const ih = hdr_int::access(pkt);
+    if (ih->collect_ || ih->nhops_ == 0) {
+        return;
+    }
+
+    if (nhops_ != ih->nhops_) {
+        // first feedback or the path changed: nothing to compare against
+        reference_window_ = agent().cwnd_;
+    } else {
+        auto const ackno = hdr_tcp::access(pkt)->ackno();
+        auto const update_reference = ackno > last_update_seq_;
+        if (update_reference) {
+            last_update_seq_ = maxseq_;
+        }
+        auto const window = compute_window(measure_inflight(ih), update_reference);
+        agent().cwnd_ = std::max(window, 1.0);
+    }
+
+    nhops_ = ih->nhops_;
+    std::copy(ih->hops_, ih->hops_ + nhops_, hops_.begin());
+}
+
+/*
+ * Utilisation of the most loaded hop since the previous ACK, smoothed over
+ * one base RTT.
+ */
+auto HpccSenderCETracker::measure_inflight(hdr_int const * ih) -> double {
+    auto max_utilisation = -1.0;
+    auto tau = base_rtt_;
+    for (int i = 0; i < nhops_; ++i) {
+        auto const& cur = ih->hops_[i];
+        auto const& prev = hops_[i];
+        auto const dt = cur.ts_ - prev.ts_;
+        if (dt <= 0 || cur.rate_ <= 0) {
+            continue;
+        }
+        auto const tx_rate = 8 * (cur.tx_bytes_ - prev.tx_bytes_) / dt;
+        auto const qlen = std::min(cur.qlen_, prev.qlen_);
+        auto const hop_utilisation =
+            8.0 * qlen / (cur.rate_ * base_rtt_) + tx_rate / cur.rate_;
+        if (hop_utilisation > max_utilisation) {
+            max_utilisation = hop_utilisation;
+            tau = dt;
+        }
+    }
+    if (max_utilisation < 0) {
+        return utilisation_;
+    }
+
+    tau = std::min(tau, base_rtt_);
+    utilisation_ = (1 - tau / base_rtt_) * utilisation_
+        + tau / base_rtt_ * max_utilisation;
+    return utilisation_;
+}
+
+auto HpccSenderCETracker::compute_window(
+        double utilisation, bool update_reference) -> double {
+    double window;
+    if (utilisation >= eta_ || (inc_stage_ >= max_stage_ && utilisation > 0)) {
+        window = reference_window_ / (utilisation / eta_) + wai_;
+        if (update_reference) {
+            inc_stage_ = 0;
+            reference_window_ = window;
+        }
+    } else {
+        window = reference_window_ + wai_;
+        if (update_reference) {
+            ++inc_stage_;
+            reference_window_ = window;
+        }
+    }
+    return window;
+}
+
+auto HpccSenderCETracker::is_opencwnd_adjustment_enabled() const -> bool {
+    return false;
+}
+
+auto HpccSenderCETracker::opencwnd_multiplier() -> double {
+    throw std::logic_error("Opencwnd adjustment is disabled!");
+}
+
+auto HpccSenderCETracker::should_slowdown_on_dup_ack() const -> bool {
+    return false;
+}
+
+auto HpccSenderCETracker::always_report_ect() const -> bool {
+    return false;
+}
+
+auto HpccSenderCETracker::is_ecn_active([[maybe_unused]] Packet * pkt) const -> bool {
+    return false;
+}
+
+SwiftSenderCETracker::SwiftSenderCETracker(FullTcpAgent * agent)
+    : base_target_{0.00005}
+    , per_hop_{0.000002}
+    , fs_range_{0.00005}
+    , fs_min_cwnd_{1}
+    , fs_max_cwnd_{100}
+    , ai_{1}
+    , beta_{0.8}
+    , max_mdf_{0.5}
+    , last_decrease_{0}
+    , rtt_{0}
+    , agent_{agent}
+{}
+
+auto SwiftSenderCETracker::agent() -> FullTcpAgent& {
+    return *agent_;
+}
+
+auto SwiftSenderCETracker::agent() const -> FullTcpAgent const& {
+    return *agent_;
+}
+
+void SwiftSenderCETracker::delay_bind_init_all() {
+    agent().delay_bind_init_one("swift_base_target_");
+    agent().delay_bind_init_one("swift_per_hop_");
+    agent().delay_bind_init_one("swift_fs_range_");
+    agent().delay_bind_init_one("swift_fs_min_cwnd_");
+    agent().delay_bind_init_one("swift_fs_max_cwnd_");
+    agent().delay_bind_init_one("swift_ai_");
+    agent().delay_bind_init_one("swift_beta_");
+    agent().delay_bind_init_one("swift_max_mdf_");
+}
+
+auto SwiftSenderCETracker::delay_bind_dispatch(
+        const char *varName, const char *localName, TclObject *tracer) -> bool {
+    if (agent().delay_bind(varName, localName, "swift_base_target_", &base_target_, tracer)) return true;
+    if (agent().delay_bind(varName, localName, "swift_per_hop_", &per_hop_, tracer)) return true;
+    if (agent().delay_bind(varName, localName, "swift_fs_range_", &fs_range_, tracer)) return true;
+    if (agent().delay_bind(varName, localName, "swift_fs_min_cwnd_", &fs_min_cwnd_, tracer)) return true;
+    if (agent().delay_bind(varName, localName, "swift_fs_max_cwnd_", &fs_max_cwnd_, tracer)) return true;
+    if (agent().delay_bind(varName, localName, "swift_ai_", &ai_, tracer)) return true;
+    if (agent().delay_bind(varName, localName, "swift_beta_", &beta_, tracer)) return true;
+    if (agent().delay_bind(varName, localName, "swift_max_mdf_", &max_mdf_, tracer)) return true;
+    return false;
+}
+
+void SwiftSenderCETracker::on_receive(Packet * pkt) {
+    auto const tcph = hdr_tcp::access(pkt);
+    if (tcph->tx_ts_echo() < 0) {
+        return;
+    }
+
+    auto const now = Scheduler::instance().clock();
+    rtt_ = now - tcph->tx_ts_echo() - tcph->ack_delay();
+
+    auto const acked_bytes = tcph->ackno() - agent().highest_ack_;
+    if (acked_bytes <= 0) {
+        return;
+    }
+    auto const acked = double(acked_bytes) / agent().size();
+
+    double cwnd = agent().cwnd_;
+    if (rtt_ < target_delay(tcph->hops_echo())) {
+        cwnd += cwnd >= 1 ? ai_ / cwnd * acked : ai_ * acked;
+    } else if (now - last_decrease_ >= rtt_) {
+        auto const excess = (rtt_ - target_delay(tcph->hops_echo())) / rtt_;
+        cwnd *= std::max(1 - beta_ * excess, 1 - max_mdf_);
+        last_decrease_ = now;
+    }
+    agent().cwnd_ = std::max(cwnd, 1.0);
+}
+
+void SwiftSenderCETracker::on_timeout() {
+    last_decrease_ = Scheduler::instance().clock();
+}
+
+auto SwiftSenderCETracker::target_delay(int hops) const -> double {
+    return base_target_ + hops * per_hop_ + flow_scaling();
+}
+
+auto SwiftSenderCETracker::flow_scaling() const -> double {
+    if (fs_range_ <= 0 || fs_max_cwnd_ <= fs_min_cwnd_) {
+        return 0;
+    }
+    auto const alpha = fs_range_
+        / (1 / std::sqrt(fs_min_cwnd_) - 1 / std::sqrt(fs_max_cwnd_));
+    auto const beta = -alpha / std::sqrt(fs_max_cwnd_);
+    double const cwnd = agent().cwnd_;
+    return std::clamp(alpha / std::sqrt(cwnd) + beta, 0.0, fs_range_);
+}
+
+auto SwiftSenderCETracker::is_opencwnd_adjustment_enabled() const -> bool {
+    return false;
+}
+
+auto SwiftSenderCETracker::opencwnd_multiplier() -> double {
+    throw std::logic_error("Opencwnd adjustment is disabled!");
+}
+
+auto SwiftSenderCETracker::should_slowdown_on_dup_ack() const -> bool {
+    return false;
+}
+
+auto SwiftSenderCETracker::always_report_ect() const -> bool {
+    return false;
+}
+
+auto SwiftSenderCETracker::is_ecn_active([[maybe_unused]] Packet * pkt) const -> bool {
+    return false;
+}
@@ -3,8 +3,11 @@
 
 #include "ecn/senders.h"
 #include "flags.h"
+#include "telemetry.h"
 #include "tcp-full.h"
 
+#include <array>
+
 class AfabricEcnhatSenderCETracker : public EcnhatSenderCETracker {
     using super = EcnhatSenderCETracker;
 public:
@@ -18,4 +21,120 @@ protected:
 
 };
 
+/*
+ * HPCC: the window follows the utilisation of the most loaded hop, as
+ * reported by the INT records the receiver echoes in its ACKs.  CE marks
+ * are ignored and the window is never opened by the usual ACK clocking.
+ *
+ * Only the window is controlled; FullTcpAgent has no per-flow pacer, so
+ * the rate W / T of the paper is left to ACK clocking.
+ */
+class HpccSenderCETracker : public SenderCETracker {
+public:
+    explicit HpccSenderCETracker(FullTcpAgent * agent);
+
+    void on_receive(Packet * pkt) override;
+    void on_foutput(int highest) override;
+    void on_timeout() override;
+
+    void delay_bind_init_all() override;
+    auto delay_bind_dispatch(
+            const char *varName, const char *localName, TclObject *tracer
+        ) -> bool override;
+
+    void ecn_slowdown() override {}
+
+    auto is_opencwnd_adjustment_enabled() const -> bool override;
+    auto opencwnd_multiplier() -> double override;
+
+    auto should_slowdown_on_dup_ack() const -> bool override;
+
+    auto always_report_ect() const -> bool override;
+
+    auto is_ecn_active(Packet * pkt) const -> bool override;
+
+private:
+    auto measure_inflight(hdr_int const * ih) -> double;
+    auto compute_window(double utilisation, bool update_reference) -> double;
+
+    auto agent() -> FullTcpAgent&;
+
+private:
+    double eta_;        // target utilisation
+    double wai_;        // additive increase, packets
+    int max_stage_;     // additive steps before a multiplicative one
+    double base_rtt_;   // T, seconds
+
+    double utilisation_;
+    double reference_window_;   // W^c
+    int inc_stage_;
+    int last_update_seq_;
+    int maxseq_;
+
+    int nhops_;         // 0 until the first echoed records arrive
+    std::array<IntHop, hdr_int::MAX_HOPS> hops_;
+
+    FullTcpAgent * const agent_;
+};
+
+/*
+ * Swift: delay-based window control.  The RTT sample of every ACK is
+ * taken from the per-packet tx timestamp the receiver echoes, minus the
+ * time the receiver held the packet back, so it is neither tick-granular
+ * nor inflated by delayed ACKs.  The window grows additively while the
+ * sample is below the target and shrinks in proportion to the excess at
+ * most once per RTT otherwise.  The target grows with the hop count and,
+ * for small windows, with 1/sqrt(cwnd) so that many flows sharing a
+ * bottleneck still converge to a fair share.
+ *
+ * FullTcpAgent cannot send with cwnd below one packet, so the window is
+ * clamped there instead of switching to the paper's pacing mode.
+ */
+class SwiftSenderCETracker : public SenderCETracker {
+public:
+    explicit SwiftSenderCETracker(FullTcpAgent * agent);
+
+    void on_receive(Packet * pkt) override;
+    void on_foutput([[maybe_unused]] int highest) override {}
+    void on_timeout() override;
+
+    void delay_bind_init_all() override;
+    auto delay_bind_dispatch(
+            const char *varName, const char *localName, TclObject *tracer
+        ) -> bool override;
+
+    void ecn_slowdown() override {}
+
+    auto is_opencwnd_adjustment_enabled() const -> bool override;
+    auto opencwnd_multiplier() -> double override;
+
+    auto should_slowdown_on_dup_ack() const -> bool override;
+
+    auto always_report_ect() const -> bool override;
+
+    auto is_ecn_active(Packet * pkt) const -> bool override;
+
+private:
+    auto target_delay(int hops) const -> double;
+    auto flow_scaling() const -> double;
+
+    auto agent() -> FullTcpAgent&;
+    auto agent() const -> FullTcpAgent const&;
+
+private:
+    double base_target_;    // seconds
+    double per_hop_;        // seconds of target per traversed link
+    double fs_range_;       // seconds added at fs_min_cwnd_
+    double fs_min_cwnd_;
+    double fs_max_cwnd_;    // no flow scaling above this window
+    double ai_;             // additive increase per RTT, packets
+    double beta_;           // multiplicative decrease gain
+    double max_mdf_;        // largest decrease in one step
+
+    double last_decrease_;
+    double rtt_;            // last sample
+
+    FullTcpAgent * const agent_;
+};
+
 #endif // ns_tcp_ecn_tcp_full_senders_h
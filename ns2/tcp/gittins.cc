@@ -0,0 +1,95 @@
+#include "gittins.h"
+#include "ranvar.h"
+
+#include <cmath>
+#include <map>
+#include <stdexcept>
+
+namespace {
+
+auto read_cdf(std::string const& path) -> std::vector<std::pair<double, double>> {
+    // shared with RandomVariable/Empirical, so the file is parsed once
+    auto const& table = *EmpiricalCDF::load(path);
+
+    std::vector<std::pair<double, double>> cdf;
+    for (int i = 0; i < table.size(); ++i) {
+        cdf.emplace_back(table[i].val_, table[i].cdf_);
+    }
+    return cdf;
+}
+
+/*
+ * P(size <= k) for the integral interpolation of the CDF points.
+ */
+auto probability_at_most(
+        std::vector<std::pair<double, double>> const& cdf,
+        std::size_t& segment, int k) -> double {
+    while (segment + 1 < cdf.size() && cdf[segment + 1].first <= k) {
+        ++segment;
+    }
+    auto const [v1, c1] = cdf[segment];
+    if (k < v1) {
+        return 0;
+    }
+    if (segment + 1 == cdf.size()) {
+        return c1;
+    }
+    auto const [v2, c2] = cdf[segment + 1];
+    return c1 + (k - v1) / (v2 - v1) * (c2 - c1);
+}
+
+}
+
+auto GittinsTable::load(std::string const& cdf_path) -> std::shared_ptr<GittinsTable const> {
+    static std::map<std::string, std::shared_ptr<GittinsTable const>> cache;
+
+    auto& table = cache[cdf_path];
+    if (!table) {
+        table = std::make_shared<GittinsTable const>(read_cdf(cdf_path));
+    }
+    return table;
+}
+
+GittinsTable::GittinsTable(std::vector<std::pair<double, double>> const& cdf) {
+    // F[k] = P(size <= k) and T[k] = sum_{j < k} (1 - F[j]), up to the
+    // first size that completes every flow
+    std::vector<double> F;
+    std::vector<double> T{0.0};
+    std::size_t segment = 0;
+    for (int k = 0; F.empty() || F.back() < 1; ++k) {
+        F.push_back(std::min(1.0, probability_at_most(cdf, segment, k)));
+        T.push_back(T.back() + 1 - F.back());
+        if (k >= std::ceil(cdf.back().first)) {
+            F.back() = 1;
+        }
+    }
+    auto const max_size = static_cast<int>(F.size()) - 1;
+    if (max_size == 0) {
+        throw std::runtime_error("CDF has no flow of positive size");
+    }
+
+    auto const slope = [&](int a, int b) {
+        return (F[b] - F[a]) / (T[b] - T[a]);
+    };
+
+    rank_.resize(max_size);
+    std::vector<int> hull{max_size};
+    for (int a = max_size - 1; a >= 0; --a) {
+        while (hull.size() >= 2
+                && slope(a, hull.back()) <= slope(a, hull[hull.size() - 2])) {
+            hull.pop_back();
+        }
+        rank_[a] = 1 / slope(a, hull.back());
+        hull.push_back(a);
+    }
+}
+
+auto GittinsTable::rank(int packets_sent) const -> double {
+    if (packets_sent <= 0) {
+        return rank_.front();
+    }
+    if (packets_sent >= static_cast<int>(rank_.size())) {
+        return rank_.back();
+    }
+    return rank_[packets_sent];
+}
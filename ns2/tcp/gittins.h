@@ -0,0 +1,51 @@
+#ifndef ns_gittins_h
+#define ns_gittins_h
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Gittins index of a flow size distribution, tabulated per packet of
+ * attained service.
+ *
+ * For a flow that has sent a packets the index is
+ *
+ *     G(a) = max_{b > a} (F(b) - F(a)) / sum_{a <= k < b} (1 - F(k))
+ *
+ * i.e. the best ratio of completion probability to expected service over
+ * any further quantum.  Serving the flow with the highest index first is
+ * the optimal blind policy for a known size distribution; it reduces to
+ * LAS for decreasing hazard rates and to FIFO-like behaviour for
+ * increasing ones.  The maximum is the slope from (T(a), F(a)) to the
+ * upper hull of the points to its right, T being the cumulative sum
+ * above, so the whole table is built in one right-to-left hull sweep.
+ *
+ * The distribution is read from the CDF files RandomVariable/Empirical
+ * loads, interpreted the way create_empirical_rv ... 2 samples them
+ * (integral interpolation, sizes in packets).  Tables are cached per
+ * file, since every agent of a run uses the same one.
+ */
+class GittinsTable {
+public:
+    /*
+     * Returns the table for `cdf_path`, building it on first use.
+     * Throws std::runtime_error if the file cannot be read.
+     */
+    static auto load(std::string const& cdf_path) -> std::shared_ptr<GittinsTable const>;
+
+    /* (size in packets, cumulative probability) pairs, sizes ascending */
+    explicit GittinsTable(std::vector<std::pair<double, double>> const& cdf);
+
+    /*
+     * 1 / G(packets_sent), in packets: the expected service the flow needs
+     * per unit of completion probability.  Smaller is more urgent.
+     */
+    [[nodiscard]] auto rank(int packets_sent) const -> double;
+
+private:
+    std::vector<double> rank_;
+};
+
+#endif
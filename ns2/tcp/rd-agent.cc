@@ -0,0 +1,654 @@
+#include "rd-agent.h"
+#include "flags.h"
+#include "ip.h"
+
+#include <tools/BindCachingMixin.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+int hdr_rd::offset_;
+
+namespace {
+
+class RdHeaderClass : public PacketHeaderClass {
+public:
+    RdHeaderClass() : PacketHeaderClass("PacketHeader/RD", sizeof(hdr_rd)) {
+        bind_offset(&hdr_rd::offset_);
+    }
+} class_rdhdr;
+
+class HomaAgentClass : public TclClass {
+public:
+    HomaAgentClass() : TclClass("Agent/Homa") {}
+    auto create(int, const char*const*) -> TclObject * override {
+        return new HomaAgent{};
+    }
+} class_homa_agent;
+
+class NdpAgentClass : public TclClass {
+public:
+    NdpAgentClass() : TclClass("Agent/NDP") {}
+    auto create(int, const char*const*) -> TclObject * override {
+        return new NdpAgent{};
+    }
+} class_ndp_agent;
+
+}
+
+class ReceiverDrivenAgent::RtxTimer : public TimerHandler {
+public:
+    explicit RtxTimer(ReceiverDrivenAgent * agent) : agent_{agent} {}
+
+private:
+    void expire(Event *) override {
+        agent_->on_rtx_timeout();
+    }
+
+private:
+    ReceiverDrivenAgent * agent_;
+};
+
+class ReceiverDrivenAgent::ResendTimer : public TimerHandler {
+public:
+    explicit ResendTimer(ReceiverDrivenAgent * agent) : agent_{agent} {}
+
+private:
+    void expire(Event *) override {
+        agent_->on_resend_timeout();
+    }
+
+private:
+    ReceiverDrivenAgent * agent_;
+};
+
+auto ReceiverDrivenAgent::InboundMessage::remaining() const -> int {
+    return length < 0 ? -1 : length - received_bytes;
+}
+
+ReceiverDrivenAgent::ReceiverDrivenAgent()
+    : super{PT_RD},
+      rtt_bytes_{0},
+      header_size_{40},
+      unsched_prio_{0},
+      rtx_timeout_{0.0},
+      resend_timeout_{0.0},
+      nrexmit_{0},
+      nominal_deadline_{0},
+      early_terminated_{0},
+      true_flow_size_{-1},
+      flow_remaining_{-1},
+      use_deadline_{0},
+      enable_early_expiration_{0},
+      out_{},
+      in_{},
+      next_msg_id_{0},
+      rtx_timer_{std::make_unique<RtxTimer>(this)},
+      resend_timer_{std::make_unique<ResendTimer>(this)} {
+}
+
+ReceiverDrivenAgent::~ReceiverDrivenAgent() = default;
+
+void ReceiverDrivenAgent::delay_bind_init_all() {
+    delay_bind_init_one("rtt_bytes_");
+    delay_bind_init_one("header_size_");
+    delay_bind_init_one("unsched_prio_");
+    delay_bind_init_one("rtx_timeout_");
+    delay_bind_init_one("resend_timeout_");
+    delay_bind_init_one("nrexmit_");
+    delay_bind_init_one("nominal_deadline");
+    delay_bind_init_one("early_terminated_");
+    delay_bind_init_one("true_flow_size_");
+    delay_bind_init_one("flow_remaining_");
+    delay_bind_init_one("use_deadline");
+    delay_bind_init_one("enable_early_expiration_");
+    super::delay_bind_init_all();
+}
+
+int ReceiverDrivenAgent::delay_bind_dispatch(
+        const char *varName, const char *localName, TclObject *tracer) {
+    if (delay_bind(varName, localName, "rtt_bytes_", &rtt_bytes_, tracer)) return TCL_OK;
+    if (delay_bind(varName, localName, "header_size_", &header_size_, tracer)) return TCL_OK;
+    if (delay_bind(varName, localName, "unsched_prio_", &unsched_prio_, tracer)) return TCL_OK;
+    if (delay_bind(varName, localName, "rtx_timeout_", &rtx_timeout_, tracer)) return TCL_OK;
+    if (delay_bind(varName, localName, "resend_timeout_", &resend_timeout_, tracer)) return TCL_OK;
+    if (delay_bind(varName, localName, "nrexmit_", &nrexmit_, tracer)) return TCL_OK;
+    if (delay_bind(varName, localName, "nominal_deadline", &nominal_deadline_, tracer)) return TCL_OK;
+    if (delay_bind(varName, localName, "early_terminated_", &early_terminated_, tracer)) return TCL_OK;
+    if (delay_bind(varName, localName, "true_flow_size_", &true_flow_size_, tracer)) return TCL_OK;
+    if (delay_bind(varName, localName, "flow_remaining_", &flow_remaining_, tracer)) return TCL_OK;
+    if (delay_bind_bool(varName, localName, "use_deadline", &use_deadline_, tracer)) return TCL_OK;
+    if (delay_bind_bool(varName, localName, "enable_early_expiration_", &enable_early_expiration_, tracer)) return TCL_OK;
+    return super::delay_bind_dispatch(varName, localName, tracer);
+}
+
+int ReceiverDrivenAgent::command(int argc, const char*const* argv) {
+    if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+        reset_state();
+        return TCL_OK;
+    }
+    if (argc == 3 && strcmp(argv[1], "advanceby") == 0) {
+        // warm-up traffic: a message nobody waits for
+        start_message(false);
+        append(atoi(argv[2]) * size_, true);
+        return TCL_OK;
+    }
+    return super::command(argc, argv);
+}
+
+void ReceiverDrivenAgent::listen() {
+    // both ends of a pair are symmetric, nothing to set up
+}
+
+void ReceiverDrivenAgent::sendmsg(int nbytes, const char *flags) {
+    if (flags != nullptr && strcmp(flags, "DAT_NEW") == 0) {
+        start_message(false);
+        return;
+    }
+
+    if (out_.done) {
+        start_message(false);
+    }
+
+    auto const eof = flags != nullptr
+        && (strcmp(flags, "DAT_EOF") == 0 || strcmp(flags, "MSG_EOF") == 0);
+    if (eof) {
+        out_.signal_on_done = true;
+    }
+    append(nbytes, eof);
+}
+
+void ReceiverDrivenAgent::start_message(bool signal_on_done) {
+    rtx_timer_->force_cancel();
+    out_ = OutboundMessage{};
+    out_.id = next_msg_id_++;
+    out_.granted = rtt_bytes_;
+    out_.prio = unsched_prio_;
+    out_.signal_on_done = signal_on_done;
+    out_.done = false;
+}
+
+void ReceiverDrivenAgent::append(int nbytes, bool eof) {
+    out_.buffered += std::max(nbytes, 0);
+    out_.eof = out_.eof || eof;
+
+    if (out_.eof && out_.buffered == 0) {
+        finish_outbound();
+        return;
+    }
+    send_available();
+}
+
+void ReceiverDrivenAgent::send_available() {
+    auto const limit = std::min(out_.buffered, out_.granted);
+    while (out_.next_offset < limit) {
+        auto const length = std::min(size_, limit - out_.next_offset);
+        send_data(out_.next_offset, length);
+        out_.next_offset += length;
+    }
+
+    if (out_.next_offset > out_.acked
+            && rtx_timer_->status() != TimerStatus::PENDING) {
+        rtx_timer_->resched(rtx_timeout_);
+    }
+}
+
+auto ReceiverDrivenAgent::data_priority(int offset) const -> int {
+    return offset < rtt_bytes_ ? unsched_prio_ : out_.prio;
+}
+
+void ReceiverDrivenAgent::send_data(int offset, int length) {
+    auto pkt = allocpkt();
+    hdr_cmn::access(pkt)->size() = length + header_size_;
+    hdr_ip::access(pkt)->prio() = data_priority(offset);
+
+    auto rh = hdr_rd::access(pkt);
+    rh->type_ = RdPacketType::DATA;
+    rh->msg_id_ = out_.id;
+    rh->byte_offset_ = offset;
+    rh->length_ = length;
+    rh->msg_length_ = out_.eof ? out_.buffered : -1;
+    rh->grant_offset_ = 0;
+    rh->grant_prio_ = 0;
+    rh->received_ = 0;
+
+    hdr_flags::access(pkt)->trimmable_ = 1;
+    send(pkt, nullptr);
+}
+
+void ReceiverDrivenAgent::send_control(RdPacketType type, int offset, int length) {
+    auto pkt = allocpkt();
+    hdr_cmn::access(pkt)->size() = header_size_;
+    // control packets always travel in the highest priority lane
+    hdr_ip::access(pkt)->prio() = 0;
+
+    auto rh = hdr_rd::access(pkt);
+    rh->type_ = type;
+    rh->msg_id_ = in_.id;
+    rh->byte_offset_ = offset;
+    rh->length_ = length;
+    rh->msg_length_ = in_.length;
+    rh->grant_offset_ = in_.granted;
+    rh->grant_prio_ = in_.grant_prio;
+    rh->received_ = in_.received;
+    send(pkt, nullptr);
+}
+
+void ReceiverDrivenAgent::grant(int grant_offset, int grant_prio) {
+    if (grant_offset <= in_.granted && grant_prio == in_.grant_prio) {
+        return;
+    }
+    in_.granted = std::max(in_.granted, grant_offset);
+    in_.grant_prio = grant_prio;
+    send_control(RdPacketType::GRANT);
+}
+
+void ReceiverDrivenAgent::finish_outbound() {
+    rtx_timer_->force_cancel();
+    out_.done = true;
+    if (out_.signal_on_done) {
+        out_.signal_on_done = false;
+        if (!notify_flow_finished()) {
+            Tcl::instance().evalf("%s done_data", name());
+        }
+    }
+}
+
+void ReceiverDrivenAgent::recv(Packet *pkt, Handler *) {
+    auto const rh = hdr_rd::access(pkt);
+    switch (rh->type_) {
+    case RdPacketType::DATA:
+        recv_data(pkt);
+        break;
+    case RdPacketType::GRANT:
+        recv_grant(rh);
+        break;
+    case RdPacketType::RESEND:
+        recv_resend(rh, true);
+        break;
+    case RdPacketType::NACK:
+        recv_resend(rh, false);
+        break;
+    case RdPacketType::DONE:
+        recv_done(rh);
+        break;
+    }
+    Packet::free(pkt);
+}
+
+void ReceiverDrivenAgent::recv_grant(hdr_rd const *rh) {
+    if (rh->msg_id_ != out_.id || out_.done) {
+        return;
+    }
+    out_.acked = std::max(out_.acked, rh->received_);
+    out_.granted = std::max(out_.granted, rh->grant_offset_);
+    out_.prio = rh->grant_prio_;
+    rtx_timer_->force_cancel();
+    send_available();
+}
+
+void ReceiverDrivenAgent::recv_resend(hdr_rd const *rh, bool is_timeout) {
+    if (rh->msg_id_ != out_.id || out_.done) {
+        return;
+    }
+    out_.acked = std::max(out_.acked, rh->received_);
+
+    auto const end = std::min(rh->byte_offset_ + rh->length_, out_.next_offset);
+    if (rh->byte_offset_ >= end) {
+        return;
+    }
+    // trimmed bytes are repaired right away and are not timeouts
+    if (is_timeout) {
+        ++nrexmit_;
+    }
+    for (auto offset = rh->byte_offset_; offset < end; offset += size_) {
+        send_data(offset, std::min(size_, end - offset));
+    }
+    rtx_timer_->resched(rtx_timeout_);
+}
+
+void ReceiverDrivenAgent::recv_done(hdr_rd const *rh) {
+    if (rh->msg_id_ != out_.id || out_.done) {
+        return;
+    }
+    out_.acked = rh->received_;
+    finish_outbound();
+}
+
+void ReceiverDrivenAgent::on_rtx_timeout() {
+    if (out_.done || out_.next_offset <= out_.acked) {
+        return;
+    }
+    // nothing heard from the receiver: probe with the first missing bytes
+    ++nrexmit_;
+    send_data(out_.acked, std::min(size_, out_.next_offset - out_.acked));
+    rtx_timer_->resched(rtx_timeout_);
+}
+
+void ReceiverDrivenAgent::start_inbound(hdr_rd const *rh) {
+    resend_timer_->force_cancel();
+    in_ = InboundMessage{};
+    in_.id = rh->msg_id_;
+    in_.granted = rtt_bytes_;
+    in_.grant_prio = unsched_prio_;
+    in_.done = false;
+}
+
+void ReceiverDrivenAgent::add_received_range(int offset, int end) {
+    offset = std::max(offset, in_.received);
+    if (offset >= end) {
+        return;
+    }
+
+    // merge [offset, end) into the out-of-order ranges, counting only
+    // the bytes that were not seen before
+    auto new_bytes = end - offset;
+    auto start = offset;
+    auto stop = end;
+    auto it = in_.out_of_order.lower_bound(offset);
+    if (it != in_.out_of_order.begin() && std::prev(it)->second >= offset) {
+        --it;
+    }
+    while (it != in_.out_of_order.end() && it->first <= end) {
+        new_bytes -= std::max(
+                std::min(it->second, end) - std::max(it->first, offset), 0);
+        start = std::min(start, it->first);
+        stop = std::max(stop, it->second);
+        it = in_.out_of_order.erase(it);
+    }
+
+    if (start <= in_.received) {
+        in_.received = stop;
+    } else {
+        in_.out_of_order.emplace(start, stop);
+    }
+
+    in_.received_bytes += new_bytes;
+    if (flow_remaining_ > 0) {
+        flow_remaining_ = std::max(flow_remaining_ - new_bytes, 0);
+    }
+}
+
+void ReceiverDrivenAgent::recv_data(Packet *pkt) {
+    auto const rh = hdr_rd::access(pkt);
+    if (rh->msg_id_ < in_.id) {
+        return;
+    }
+    if (rh->msg_id_ > in_.id) {
+        start_inbound(rh);
+    }
+    if (in_.done) {
+        // the sender missed our DONE
+        send_control(RdPacketType::DONE);
+        return;
+    }
+
+    if (rh->msg_length_ >= 0) {
+        in_.length = rh->msg_length_;
+    }
+    if (hdr_flags::access(pkt)->trimmed_) {
+        recv_trimmed(rh);
+        return;
+    }
+    add_received_range(rh->byte_offset_, rh->byte_offset_ + rh->length_);
+
+    if (in_.length >= 0 && in_.received >= in_.length) {
+        resend_timer_->force_cancel();
+        in_.done = true;
+        flow_remaining_ = -1;
+        send_control(RdPacketType::DONE);
+        on_inbound_finished();
+        return;
+    }
+
+    if (in_.out_of_order.empty()) {
+        resend_timer_->force_cancel();
+    } else if (resend_timer_->status() != TimerStatus::PENDING) {
+        resend_timer_->resched(resend_timeout_);
+    }
+    on_inbound_progress();
+}
+
+void ReceiverDrivenAgent::recv_trimmed(hdr_rd const *rh) {
+    send_control(RdPacketType::NACK, rh->byte_offset_, rh->length_);
+    on_inbound_trimmed();
+}
+
+void ReceiverDrivenAgent::on_resend_timeout() {
+    if (in_.done || in_.out_of_order.empty()) {
+        return;
+    }
+    auto const hole_end = in_.out_of_order.begin()->first;
+    send_control(RdPacketType::RESEND, in_.received, hole_end - in_.received);
+    resend_timer_->resched(resend_timeout_);
+}
+
+void ReceiverDrivenAgent::reset_state() {
+    rtx_timer_->force_cancel();
+    resend_timer_->force_cancel();
+    auto const was_active = in_.is_active();
+    out_ = OutboundMessage{};
+    in_ = InboundMessage{};
+    if (was_active) {
+        on_inbound_finished();
+    }
+}
+
+class HomaAgent::GrantScheduler {
+public:
+    void activate(HomaAgent * agent) {
+        if (std::find(active_.begin(), active_.end(), agent) == active_.end()) {
+            active_.push_back(agent);
+        }
+    }
+
+    void deactivate(HomaAgent * agent) {
+        active_.erase(
+                std::remove(active_.begin(), active_.end(), agent),
+                active_.end());
+    }
+
+    void schedule() {
+        std::stable_sort(active_.begin(), active_.end(), &ranks_before);
+        for (auto rank = 0; rank < static_cast<int>(active_.size()); ++rank) {
+            active_[rank]->update_grant(rank);
+        }
+    }
+
+    static auto for_node(nsaddr_t node) -> GrantScheduler& {
+        auto& scheduler = schedulers_[node];
+        if (!scheduler) {
+            scheduler = std::make_unique<GrantScheduler>();
+        }
+        return *scheduler;
+    }
+
+private:
+    static auto ranks_before(HomaAgent const * lhs, HomaAgent const * rhs) -> bool {
+        auto const& l = lhs->inbound();
+        auto const& r = rhs->inbound();
+        auto const l_known = l.length >= 0;
+        auto const r_known = r.length >= 0;
+        if (l_known != r_known) {
+            return l_known;
+        }
+        if (l_known) {
+            return l.remaining() < r.remaining();
+        }
+        return l.received_bytes < r.received_bytes;
+    }
+
+private:
+    std::vector<HomaAgent*> active_;
+
+    static std::unordered_map<nsaddr_t, std::unique_ptr<GrantScheduler>> schedulers_;
+};
+
+std::unordered_map<nsaddr_t, std::unique_ptr<HomaAgent::GrantScheduler>>
+    HomaAgent::GrantScheduler::schedulers_{};
+
+HomaAgent::HomaAgent()
+    : overcommit_{1},
+      sched_prio_base_{1},
+      sched_prio_num_{1},
+      scheduler_{nullptr} {
+}
+
+HomaAgent::~HomaAgent() {
+    if (scheduler_ != nullptr) {
+        scheduler_->deactivate(this);
+    }
+}
+
+void HomaAgent::delay_bind_init_all() {
+    delay_bind_init_one("overcommit_");
+    delay_bind_init_one("sched_prio_base_");
+    delay_bind_init_one("sched_prio_num_");
+    super::delay_bind_init_all();
+}
+
+int HomaAgent::delay_bind_dispatch(
+        const char *varName, const char *localName, TclObject *tracer) {
+    if (delay_bind(varName, localName, "overcommit_", &overcommit_, tracer)) return TCL_OK;
+    if (delay_bind(varName, localName, "sched_prio_base_", &sched_prio_base_, tracer)) return TCL_OK;
+    if (delay_bind(varName, localName, "sched_prio_num_", &sched_prio_num_, tracer)) return TCL_OK;
+    return super::delay_bind_dispatch(varName, localName, tracer);
+}
+
+auto HomaAgent::scheduler() -> GrantScheduler& {
+    if (scheduler_ == nullptr) {
+        scheduler_ = &GrantScheduler::for_node(addr());
+    }
+    return *scheduler_;
+}
+
+void HomaAgent::on_inbound_progress() {
+    auto& sched = scheduler();
+    sched.activate(this);
+    sched.schedule();
+}
+
+void HomaAgent::on_inbound_finished() {
+    auto& sched = scheduler();
+    sched.deactivate(this);
+    sched.schedule();
+}
+
+void HomaAgent::update_grant(int rank) {
+    if (rank >= overcommit_) {
+        return;
+    }
+    auto const& in = inbound();
+    auto offset = in.received + unscheduled_bytes();
+    if (in.length >= 0) {
+        offset = std::min(offset, in.length);
+    }
+    auto const prio = sched_prio_base_ + std::min(rank, sched_prio_num_ - 1);
+    grant(offset, prio);
+}
+
+class NdpAgent::PullPacer : public TimerHandler {
+public:
+    explicit PullPacer(double interval) : interval_{interval} {}
+
+    void request(NdpAgent * agent) {
+        pending_.push_back(agent);
+        if (status() == TimerStatus::IDLE) {
+            sched(0);
+        }
+    }
+
+    void cancel(NdpAgent * agent) {
+        pending_.erase(
+                std::remove(pending_.begin(), pending_.end(), agent),
+                pending_.end());
+    }
+
+    static auto for_node(nsaddr_t node, double interval) -> PullPacer& {
+        auto& pacer = pacers_[node];
+        if (!pacer) {
+            pacer = std::make_unique<PullPacer>(interval);
+        }
+        return *pacer;
+    }
+
+private:
+    void expire(Event *) override {
+        if (pending_.empty()) {
+            return;
+        }
+        auto const agent = pending_.front();
+        pending_.pop_front();
+        agent->pull();
+        if (!pending_.empty()) {
+            resched(interval_);
+        }
+    }
+
+private:
+    double interval_;
+    std::deque<NdpAgent*> pending_;
+
+    static std::unordered_map<nsaddr_t, std::unique_ptr<PullPacer>> pacers_;
+};
+
+std::unordered_map<nsaddr_t, std::unique_ptr<NdpAgent::PullPacer>>
+    NdpAgent::PullPacer::pacers_{};
+
+NdpAgent::NdpAgent()
+    : link_rate_{10.0},
+      pacer_{nullptr} {
+}
+
+NdpAgent::~NdpAgent() {
+    if (pacer_ != nullptr) {
+        pacer_->cancel(this);
+    }
+}
+
+void NdpAgent::delay_bind_init_all() {
+    delay_bind_init_one("link_rate_");
+    super::delay_bind_init_all();
+}
+
+int NdpAgent::delay_bind_dispatch(
+        const char *varName, const char *localName, TclObject *tracer) {
+    if (delay_bind(varName, localName, "link_rate_", &link_rate_, tracer)) return TCL_OK;
+    return super::delay_bind_dispatch(varName, localName, tracer);
+}
+
+auto NdpAgent::pacer() -> PullPacer& {
+    if (pacer_ == nullptr) {
+        auto const bits = 8.0 * (payload_size() + header_size_);
+        pacer_ = &PullPacer::for_node(addr(), bits / (link_rate_ * 1e9));
+    }
+    return *pacer_;
+}
+
+void NdpAgent::on_inbound_progress() {
+    pacer().request(this);
+}
+
+void NdpAgent::on_inbound_finished() {
+    pacer().cancel(this);
+}
+
+void NdpAgent::on_inbound_trimmed() {
+    // the NACKed retransmission is this header's packet, no extra PULL
+}
+
+void NdpAgent::pull() {
+    auto const& in = inbound();
+    if (!in.is_active()) {
+        return;
+    }
+    auto offset = in.granted + payload_size();
+    if (in.length >= 0) {
+        offset = std::min(offset, in.length);
+    }
+    grant(offset, in.grant_prio);
+}
@@ -0,0 +1,259 @@
+#ifndef ns_rd_agent_h
+#define ns_rd_agent_h
+
+#include "agent.h"
+#include "packet.h"
+#include "timer-handler.h"
+#include <tools/BindCachingMixin.h>
+#include <tools/FlowEndpoint.h>
+
+#include <map>
+#include <memory>
+
+/*
+ * Receiver-driven transports (Homa, pHost, NDP).
+ *
+ * The sender blindly transmits the first rtt_bytes_ of every message
+ * (the unscheduled part) and afterwards only what the receiver allows.
+ * The receiver decides which of its inbound messages may send next and
+ * at which in-network priority (hdr_ip::prio, consumed by
+ * Queue/Priority and Queue/DropTail with deque_prio_).
+ *
+ * DATA packets are marked trimmable: a queue with trim_ enabled forwards
+ * the header of an overflowing packet instead of dropping it, and the
+ * receiver immediately asks for the cut bytes with a NACK, so losses are
+ * repaired within one RTT instead of a timeout.
+ *
+ * Agents are used in pairs exactly like FullTcpAgent: the application
+ * starts every message with "DAT_NEW" and marks the last bytes with
+ * "DAT_EOF", after which done_data is invoked on the sender (or its
+ * FlowObserver notified) once the receiver has confirmed the whole
+ * message.
+ */
+
+enum class RdPacketType : int {
+    DATA,
+    GRANT,
+    RESEND,
+    DONE,
+    NACK,   // a queue trimmed the DATA in [offset, offset + length)
+};
+
+struct hdr_rd {
+    RdPacketType type_;
+    int msg_id_;        // message number within the connection
+    int byte_offset_;   // DATA/RESEND: first byte carried/requested
+    int length_;        // DATA/RESEND: number of bytes carried/requested
+    int msg_length_;    // DATA: total message size, -1 while unknown
+    int grant_offset_;  // GRANT: sender may transmit bytes below this
+    int grant_prio_;    // GRANT: priority of the scheduled packets
+    int received_;      // receiver cumulative offset (all control packets)
+
+    static int offset_;
+    inline static auto access(Packet const * p) -> hdr_rd* {
+        return reinterpret_cast<hdr_rd*>(p->access(offset_));
+    }
+};
+
+class ReceiverDrivenAgent : public BindCachingMixin<Agent>, public FlowEndpoint {
+    using super = BindCachingMixin<Agent>;
+public:
+    ReceiverDrivenAgent();
+    ~ReceiverDrivenAgent() override;
+
+    void sendmsg(int nbytes, const char *flags = nullptr) override;
+    void recv(Packet *pkt, Handler *) override;
+    void listen() override;
+
+    void set_true_flow_size(int bytes) override { true_flow_size_ = bytes; }
+    void set_flow_remaining(int bytes) override { flow_remaining_ = bytes; }
+    auto retransmit_timeouts() const -> int override { return nrexmit_; }
+    auto flow_deadline() const -> int override { return nominal_deadline_; }
+    auto flow_early_terminated() const -> int override { return early_terminated_; }
+
+protected:
+    int command(int argc, const char*const* argv) override;
+    void delay_bind_init_all() override;
+    int delay_bind_dispatch(
+            const char *varName, const char *localName, TclObject *tracer
+        ) override;
+
+protected:
+    struct OutboundMessage {
+        int id = -1;
+        int buffered = 0;       // bytes handed over by the application
+        bool eof = false;       // buffered is the final message size
+        bool signal_on_done = false;
+        int next_offset = 0;    // first byte never transmitted
+        int granted = 0;        // bytes below this may be transmitted
+        int acked = 0;          // receiver cumulative offset
+        int prio = 0;           // priority of scheduled packets
+        bool done = true;
+    };
+
+    struct InboundMessage {
+        int id = -1;
+        int length = -1;        // -1 until the sender reports the size
+        int received = 0;       // cumulative offset
+        int received_bytes = 0; // including out-of-order bytes
+        int granted = 0;
+        int grant_prio = 0;
+        std::map<int, int> out_of_order; // offset -> end
+        bool done = true;
+
+        [[nodiscard]] auto is_active() const -> bool { return !done; }
+        [[nodiscard]] auto remaining() const -> int;
+    };
+
+protected:
+    /*
+     * Receiver policy hooks: called whenever an inbound message made
+     * progress, finished or was abandoned.
+     */
+    virtual void on_inbound_progress() = 0;
+    virtual void on_inbound_finished() = 0;
+    /*
+     * A trimmed header arrived and was NACKed; by default like progress.
+     */
+    virtual void on_inbound_trimmed() { on_inbound_progress(); }
+
+    /*
+     * Sender policy hook: priority of a DATA packet carrying `offset`.
+     */
+    [[nodiscard]] virtual auto data_priority(int offset) const -> int;
+
+    void grant(int grant_offset, int grant_prio);
+    void send_control(RdPacketType type, int offset = 0, int length = 0);
+
+    [[nodiscard]] auto inbound() const -> InboundMessage const& {
+        return in_;
+    }
+    [[nodiscard]] auto outbound() const -> OutboundMessage const& {
+        return out_;
+    }
+
+    [[nodiscard]] auto payload_size() const -> int { return size_; }
+    [[nodiscard]] auto unscheduled_bytes() const -> int { return rtt_bytes_; }
+
+private:
+    class RtxTimer;
+    class ResendTimer;
+
+private:
+    void start_message(bool signal_on_done);
+    void append(int nbytes, bool eof);
+    void send_available();
+    void send_data(int offset, int length);
+    void finish_outbound();
+
+    void recv_data(Packet *pkt);
+    void recv_grant(hdr_rd const *rh);
+    void recv_resend(hdr_rd const *rh, bool is_timeout);
+    void recv_trimmed(hdr_rd const *rh);
+    void recv_done(hdr_rd const *rh);
+    void start_inbound(hdr_rd const *rh);
+    void add_received_range(int offset, int end);
+
+    void on_rtx_timeout();
+    void on_resend_timeout();
+
+    void reset_state();
+
+protected:
+    int rtt_bytes_;
+    int header_size_;
+    int unsched_prio_;
+    double rtx_timeout_;
+    double resend_timeout_;
+
+    // read by TCP_pair, kept with the FullTcpAgent names
+    int nrexmit_;
+    int nominal_deadline_;
+    int early_terminated_;
+    int true_flow_size_;
+    int flow_remaining_;
+    int use_deadline_;
+    int enable_early_expiration_;
+
+private:
+    OutboundMessage out_;
+    InboundMessage in_;
+    int next_msg_id_;
+    std::unique_ptr<RtxTimer> rtx_timer_;
+    std::unique_ptr<ResendTimer> resend_timer_;
+};
+
+/*
+ * Homa-style receiver: every host shares one grant scheduler that ranks
+ * its active inbound messages by remaining bytes (SRPT) and keeps at most
+ * overcommit_ of them granted.  Messages whose size is not known yet (no
+ * DAT_EOF seen) rank behind all known ones, ordered by bytes received,
+ * which is the same treatment LAZY_REMAINING_SIZE gives them in
+ * FullTcpAgent.  With overcommit_ = 1 and a single scheduled priority
+ * this degenerates into pHost.
+ */
+class HomaAgent : public ReceiverDrivenAgent {
+    using super = ReceiverDrivenAgent;
+public:
+    HomaAgent();
+    ~HomaAgent() override;
+
+protected:
+    void delay_bind_init_all() override;
+    int delay_bind_dispatch(
+            const char *varName, const char *localName, TclObject *tracer
+        ) override;
+
+    void on_inbound_progress() override;
+    void on_inbound_finished() override;
+
+private:
+    class GrantScheduler;
+
+    auto scheduler() -> GrantScheduler&;
+    void update_grant(int rank);
+
+private:
+    int overcommit_;
+    int sched_prio_base_;
+    int sched_prio_num_;
+    GrantScheduler *scheduler_;
+};
+
+/*
+ * NDP-style receiver: after the unscheduled window, each arriving DATA
+ * packet earns its sender one more packet.  A trimmed header earns
+ * none: its NACK already has the sender retransmit, which takes the
+ * place of the packet the header stood for.  The PULLs
+ * (GRANTs advancing by one packet) of all inbound messages of a host
+ * leave through a shared pacer at the host link rate, so the senders
+ * together never exceed what the receiver downlink can absorb.
+ */
+class NdpAgent : public ReceiverDrivenAgent {
+    using super = ReceiverDrivenAgent;
+public:
+    NdpAgent();
+    ~NdpAgent() override;
+
+protected:
+    void delay_bind_init_all() override;
+    int delay_bind_dispatch(
+            const char *varName, const char *localName, TclObject *tracer
+        ) override;
+
+    void on_inbound_progress() override;
+    void on_inbound_finished() override;
+    void on_inbound_trimmed() override;
+
+private:
+    class PullPacer;
+
+    auto pacer() -> PullPacer&;
+    void pull();
+
+private:
+    double link_rate_;  // Gbps of the host link, paces the PULLs
+    PullPacer *pacer_;
+};
+
+#endif
@@ -346,6 +346,17 @@ FullTcpAgent::command(int argc, const char*const* argv)
 		        flow_remaining_ = atoi(argv[2]);
 		        return(TCL_OK);
 		}
+		if (strcmp(argv[1], "set-gittins-cdf") == 0) {
+			try {
+				gittins_ = GittinsTable::load(argv[2]);
+				gittins_thresh_ranks_.clear();
+			} catch (std::runtime_error const& e) {
+				Tcl::instance().resultf("%s set-gittins-cdf: %s",
+				    name(), e.what());
+				return (TCL_ERROR);
+			}
+			return (TCL_OK);
+		}
 	}
 	if (argc == 4) {
 		if (strcmp(argv[1], "sendmsg") == 0) {
@@ -532,14 +543,16 @@ FullTcpAgent::listen()
 
 /*
 * This function is invoked when the sender buffer is empty. It in turn
-* invokes the Tcl done_data procedure that was registered with TCP.
+* notifies the FlowObserver, if any, or else invokes the Tcl done_data
+* procedure that was registered with TCP.
 */
 
 void
 FullTcpAgent::bufferempty()
 {
     signal_on_empty_ = FALSE;
-    Tcl::instance().evalf("%s done_data", this->name());
+    if (!notify_flow_finished())
+        Tcl::instance().evalf("%s done_data", this->name());
 }
 
 
@@ -946,6 +959,8 @@ int FullTcpAgent::calc_unbounded_no_deadline_priority(int seq, int maxseq) {
             return maxseq - startseq_;
         case PrioScheme::BYTES_SENT:
             return seq - startseq_;
+        case PrioScheme::GITTINS:
+            return gittins_priority(seq - startseq_);
         case PrioScheme::BATCHED_REMAINING_SIZE:
             if (seq >= seq_bound_) {
                 seq_bound_ = maxseq_;
@@ -993,6 +1008,42 @@ int FullTcpAgent::piasPrio(int bytes_sent)
     }
 }
 
+/*
+ * Gittins rank of the flow in bytes (see gittins.h): lower is served first,
+ * like the size-based schemes above.
+ */
+int FullTcpAgent::gittins_priority(int bytes_sent) const
+{
+    if (!gittins_)
+        throw std::logic_error("GITTINS priority scheme needs set-gittins-cdf");
+    auto const rank = gittins_->rank(bytes_sent / maxseg_) * maxseg_;
+    return int(std::min(rank, double(std::numeric_limits<int>::max())));
+}
+
+/*
+ * Quantise the Gittins rank into the PIAS queues: the level is the number
+ * of PIAS thresholds whose rank is more urgent than ours.  For workloads
+ * where the Gittins rank grows with bytes sent this is exactly PIAS; for
+ * the others a flow is promoted again once it nears a likely size.
+ */
+int FullTcpAgent::gittins_pias_prio(int bytes_sent)
+{
+    if (!enable_pias_ || pias_prio_num_ < 1)
+        return 0;
+    auto const rank = gittins_priority(bytes_sent);
+    // the thresholds are fixed once the flows start
+    if (gittins_thresh_ranks_.empty()) {
+        for (int i = 0; i < 7; i++)
+            gittins_thresh_ranks_.push_back(gittins_priority(pias_thresh_[i]));
+    }
+    auto level = 0;
+    for (int i = 0; i < min(pias_prio_num_, 8) - 1; i++) {
+        if (rank > gittins_thresh_ranks_[i])
+            level++;
+    }
+    return level;
+}
+
 /*
  * sendpacket:
  *	allocate a packet, fill in header fields, and send
@@ -1084,7 +1135,10 @@ int FullTcpAgent::get_expiration_time_us() const {
 int FullTcpAgent::calc_pias_priority(int seqno, int datalen, hdr_ip *iph) {
     auto priority = 0;
     if (datalen > 0) {
-        priority = piasPrio(seqno - startseq_);
+        if (prio_scheme_ == PrioScheme::GITTINS)
+            priority = gittins_pias_prio(seqno - startseq_);
+        else
+            priority = piasPrio(seqno - startseq_);
         if (pias_debug_)
             printf("Packet prio is %d when bytes sent is %d\n", iph->prio(),
                    seqno - startseq_);
@@ -3079,6 +3133,8 @@ int SackFullTcpAgent::calc_unbounded_no_deadline_priority(int seq, int maxseq) {
             return maxseq - startseq_;
         case PrioScheme::BYTES_SENT:
             return seq - startseq_;
+        case PrioScheme::GITTINS:
+            return gittins_priority(seq - startseq_);
         case PrioScheme ::BATCHED_REMAINING_SIZE:
             if (int(highest_ack_) >= seq_bound_) {
                 seq_bound_ = maxseq_;
@@ -3598,13 +3654,21 @@ int DDTcpAgent::calc_unbounded_no_deadline_priority(int seq, int maxseq) {
 FullTcpAgent::EcnProcessor::EcnProcessor(FullTcpAgent * agent) 
     : TcpAgent::EcnProcessor(agent)
     , informpacer_{0}
+    , int_echo_{}
+    , echo_tx_ts_{-1}
+    , echo_rx_ts_{0}
+    , echo_hops_{0}
     , normal_recv_{std::make_unique<NormalReceiverCETracker>()}
     , ecnhat_recv_{std::make_unique<EcnhatReceiverCETracker>()}
     , afabric_recv_{std::make_unique<AFabricReceiverCETracker>()}
     , afabric_send_{std::make_unique<AfabricEcnhatSenderCETracker>(this)}
+    , hpcc_send_{std::make_unique<HpccSenderCETracker>(agent)}
+    , swift_send_{std::make_unique<SwiftSenderCETracker>(agent)}
 {
     if constexpr(std::is_base_of_v<TracedVar, FullTcpAgent::TracedInt>) {
         this->agent().bind("afabric_ecn_enabled_", &afabric_ecn_enabled_);
+        this->agent().bind("hpcc_enabled_", &hpcc_enabled_);
+        this->agent().bind("swift_enabled_", &swift_enabled_);
     }
 }
 
@@ -3673,6 +3737,41 @@ void FullTcpAgent::EcnProcessor::on_sendpacket(TcpFlags& pflags, Packet * pkt, b
     copy_to_hdr_flags(pflags, hdr_flags::access(pkt));
 
     inform_pacer_if_needed(hdr_ip::access(pkt), has_data);
+
+    stamp_int(pkt, has_data);
+    stamp_tx_ts(pkt);
+}
+
+/*
+ * Per-packet RTT samples: every packet carries its send time, and the next
+ * packet in the other direction returns the send time of the last data
+ * packet together with how long it was held back (delayed ACKs) and the
+ * number of links it crossed (from its TTL).
+ */
+void FullTcpAgent::EcnProcessor::stamp_tx_ts(Packet * pkt) {
+    auto const tcph = hdr_tcp::access(pkt);
+    auto const now = agent().now();
+    tcph->tx_ts() = now;
+    tcph->tx_ts_echo() = echo_tx_ts_;
+    tcph->ack_delay() = now - echo_rx_ts_;
+    tcph->hops_echo() = echo_hops_;
+    echo_tx_ts_ = -1;
+}
+
+/*
+ * HPCC senders ask the queues for INT records on every data packet; any
+ * receiver returns the records of the last one on its next pure ACK.
+ */
+void FullTcpAgent::EcnProcessor::stamp_int(Packet * pkt, bool has_data) {
+    auto const ih = hdr_int::access(pkt);
+    if (has_data) {
+        ih->collect_ = hpcc_enabled_;
+        ih->nhops_ = 0;
+    } else if (int_echo_.nhops_ > 0) {
+        *ih = int_echo_;
+        ih->collect_ = false;
+        int_echo_.nhops_ = 0;
+    }
 }
 
 auto FullTcpAgent::EcnProcessor::get_next_packet_ect(
@@ -3718,6 +3817,17 @@ void FullTcpAgent::EcnProcessor::copy_to_hdr_flags(TcpFlags pflags, hdr_flags *
 void FullTcpAgent::EcnProcessor::on_receive(Packet * pkt) {
     get_send_tracker().on_receive(pkt);
 
+    auto const ih = hdr_int::access(pkt);
+    if (ih->collect_)
+        int_echo_ = *ih;
+
+    auto const tcph = hdr_tcp::access(pkt);
+    if (hdr_cmn::access(pkt)->size() > tcph->hlen()) {
+        echo_tx_ts_ = tcph->tx_ts();
+        echo_rx_ts_ = agent().now();
+        echo_hops_ = agent().defttl_ - hdr_ip::access(pkt)->ttl();
+    }
+
     /* Mohammad: check if we need to inform
      * pacer of ecnecho.
      */
@@ -3842,9 +3952,13 @@ void FullTcpAgent::EcnProcessor::reset() {
 		ecn_syn_next_ = true;
 	else
 		ecn_syn_next_ = false;
+	int_echo_.nhops_ = 0;
+	echo_tx_ts_ = -1;
 }
 
 auto FullTcpAgent::EcnProcessor::can_open_cwnd(Packet * pkt) const -> bool {
+	if (hpcc_enabled_ || swift_enabled_)
+		return false;   // the window is set by the tracker only
 	return super::can_open_cwnd(pkt) || (ecn_burst() && !old_ecn_);
 }
 
@@ -3945,9 +4059,15 @@ void FullTcpAgent::EcnProcessor::on_foutput(int highest) {
 
 void FullTcpAgent::EcnProcessor::delay_bind_init_all() {
     afabric_ecn_enabled_ = false;
+    hpcc_enabled_ = false;
+    swift_enabled_ = false;
     if constexpr (!std::is_base_of_v<TracedVar, FullTcpAgent::TracedInt>) {
         agent().delay_bind_init_one("afabric_ecn_enabled_");
+        agent().delay_bind_init_one("hpcc_enabled_");
+        agent().delay_bind_init_one("swift_enabled_");
     }
+    hpcc_send_->delay_bind_init_all();
+    swift_send_->delay_bind_init_all();
     super::delay_bind_init_all();
 }
 
@@ -3955,6 +4075,16 @@ auto FullTcpAgent::EcnProcessor::delay_bind_dispatch(const char *varName, const
     if (agent().delay_bind_bool(
             varName, localName, "afabric_ecn_enabled_", &afabric_ecn_enabled_, tracer))
         return true;
+    if (agent().delay_bind_bool(
+            varName, localName, "hpcc_enabled_", &hpcc_enabled_, tracer))
+        return true;
+    if (agent().delay_bind_bool(
+            varName, localName, "swift_enabled_", &swift_enabled_, tracer))
+        return true;
+    if (hpcc_send_->delay_bind_dispatch(varName, localName, tracer))
+        return true;
+    if (swift_send_->delay_bind_dispatch(varName, localName, tracer))
+        return true;
     return super::delay_bind_dispatch(varName, localName, tracer);
 
 }
@@ -3965,7 +4095,11 @@ auto FullTcpAgent::EcnProcessor::get_send_tracker() -> SenderCETracker& {
 }
 
 auto FullTcpAgent::EcnProcessor::get_send_tracker() const -> SenderCETracker const& {
-    if (afabric_ecn_enabled_) {
+    if (hpcc_enabled_) {
+        return *hpcc_send_;
+    } else if (swift_enabled_) {
+        return *swift_send_;
+    } else if (afabric_ecn_enabled_) {
         return *afabric_send_;
     } else {
         return super::get_send_tracker();
@@ -4,10 +4,14 @@
 
 #include <memory>
 #include <limits>
+#include <vector>
 #include <common/ip.h>
 #include "flags.h"
+#include "telemetry.h"
 #include "tcp.h"
 #include "rq.h"
+#include "gittins.h"
+#include <tools/FlowEndpoint.h>
 
 /*
  * most of these defines are directly from
@@ -115,6 +119,7 @@ enum class PrioScheme : int {
     UNKNOWN = 5,
     LAZY_REMAINING_SIZE = 6,
     LAZY_REMAINING_SIZE_BYTES_SENT = 7,
+    GITTINS = 8,    // needs set-gittins-cdf, see gittins.h
 };
 
 class FullTcpAgent;
@@ -126,10 +131,12 @@ protected:
 	FullTcpAgent *a_;
 };
 
-class FullTcpAgent : public TcpAgent {
+class FullTcpAgent : public TcpAgent, public FlowEndpoint {
     using super = TcpAgent;
     class EcnProcessor;
     friend class AfabricEcnhatSenderCETracker;
+    friend class HpccSenderCETracker;
+    friend class SwiftSenderCETracker;
 
 public:
 	FullTcpAgent();
@@ -147,6 +154,12 @@ public:
     int& size() override { return maxseg_; } //FullTcp uses maxseg_ for size_
 	int command(int argc, const char*const* argv) override;
     void reset() override;       		// reset to a known point
+
+    void set_true_flow_size(int bytes) override { true_flow_size_ = bytes; }
+    void set_flow_remaining(int bytes) override { flow_remaining_ = bytes; }
+    auto retransmit_timeouts() const -> int override { return nrexmit_; }
+    auto flow_deadline() const -> int override { return nominal_deadline; }
+    auto flow_early_terminated() const -> int override { return early_terminated_; }
 protected:
     friend class EcnProcessor;  // TODO: remove
 	void delay_bind_init_all() override;
@@ -159,6 +172,8 @@ protected:
 	virtual int get_num_bytes_remaining();
 	/* Wei: PIAS priority */
 	virtual int piasPrio(int bytes_sent);
+	int gittins_priority(int bytes_sent) const;
+	int gittins_pias_prio(int bytes_sent);
 
 	PrioScheme prio_scheme_;
 	int prio_num_; //number of priorities; 0: unlimited
@@ -167,6 +182,8 @@ protected:
 	int pias_prio_num_;	//wei: number of priorities used by PIAS (no more than 8)
     int pias_thresh_[7];    //wei: demotion thresholds of PIAS
 	int pias_debug_;	//wei: debug mode for PIAS
+	std::shared_ptr<GittinsTable const> gittins_;	// for PrioScheme::GITTINS
+	std::vector<int> gittins_thresh_ranks_;	// of pias_thresh_, on first use
 	int startseq_;
 	int last_prio_;
 	int seq_bound_;
@@ -469,6 +486,8 @@ private:
     void inform_pacer_if_needed(hdr_ip *iph, bool has_data);
 
     void update_state_new_packet(Packet * packet, bool has_data);
+    void stamp_int(Packet * pkt, bool has_data);
+    void stamp_tx_ts(Packet * pkt);
 
     auto agent_has_pending_acks() const -> bool;
     void send_immediate_ack_with_previous_ce();
@@ -493,12 +512,20 @@ private:
     EcnSynAckAction ecn_syn_wait_;
 
     int afabric_ecn_enabled_;
+    int hpcc_enabled_;  // window driven by INT feedback (HpccSenderCETracker)
+    hdr_int int_echo_;  // INT records of the last data packet, for the ACK
+    int swift_enabled_; // window driven by RTT samples (SwiftSenderCETracker)
+    double echo_tx_ts_; // tx timestamp of the last data packet, -1 if echoed
+    double echo_rx_ts_; // ... and when it arrived
+    int echo_hops_;     // ... and how many links it crossed
 
     unique_ptr<ReceiverCETracker> const normal_recv_;
     unique_ptr<ReceiverCETracker> const ecnhat_recv_;
     unique_ptr<ReceiverCETracker> const afabric_recv_;
 
     unique_ptr<SenderCETracker> const afabric_send_;
+    unique_ptr<SenderCETracker> const hpcc_send_;
+    unique_ptr<SenderCETracker> const swift_send_;
 };
 
 #endif
@@ -119,6 +119,8 @@ class TcpAgent : public BindCachingMixin<Agent> {
     friend class EcnhatSenderCETracker;
     friend class NormalSenderCETracker;
     friend class TcpFriendlyEcnhatSenderCETracker;
+    friend class HpccSenderCETracker;
+    friend class SwiftSenderCETracker;
     using super = BindCachingMixin;
 protected:
     using TracedInt = int;
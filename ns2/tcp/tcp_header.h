@@ -28,6 +28,11 @@ struct hdr_tcp {
     int tcp_flags_;         /* TCP flags for FullTcp */
     int last_rtt_;		/* more recent RTT measurement in ms, */
     /*   for statistics only */
+    double tx_ts_;          /* FullTcp: time the packet left the sender */
+    double tx_ts_echo_;     /* FullTcp: tx_ts_ of the last data packet
+                               received, -1 if none since the last ACK */
+    double ack_delay_;      /* FullTcp: time that packet waited for this ACK */
+    int hops_echo_;         /* FullTcp: links that packet traversed */
 
     static int offset_;	// offset for this header
     inline static int& offset() { return offset_; }
@@ -47,6 +52,10 @@ struct hdr_tcp {
     int& ackno() { return (ackno_); }
     int& flags() { return (tcp_flags_); }
     int& last_rtt() { return (last_rtt_); }
+    double& tx_ts() { return (tx_ts_); }
+    double& tx_ts_echo() { return (tx_ts_echo_); }
+    double& ack_delay() { return (ack_delay_); }
+    int& hops_echo() { return (hops_echo_); }
 };
 
 #endif //NS2_TCP_HEADER_H
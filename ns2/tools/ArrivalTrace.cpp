@@ -0,0 +1,113 @@
+#include "ArrivalTrace.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char MAGIC[] = "AFTRACE1";
+constexpr std::size_t MAGIC_SIZE = sizeof(MAGIC) - 1;
+constexpr std::size_t RELEASE_STEP = 4 << 20;
+
+}
+
+ArrivalTrace::ArrivalTrace(std::string const& path)
+    : data_{nullptr}
+    , size_{0}
+    , position_{MAGIC_SIZE}
+    , chunks_{0}
+    , released_{0}
+{
+    auto const fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < MAGIC_SIZE) {
+        close(fd);
+        throw std::runtime_error(path + " is not an arrival trace");
+    }
+    size_ = st.st_size;
+
+    auto const data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("cannot map " + path);
+    }
+    data_ = static_cast<unsigned char const*>(data);
+    madvise(data, size_, MADV_SEQUENTIAL);
+
+    if (memcmp(data_, MAGIC, MAGIC_SIZE) != 0) {
+        munmap(data, size_);
+        throw std::runtime_error(path + " is not an arrival trace");
+    }
+}
+
+ArrivalTrace::~ArrivalTrace() {
+    munmap(const_cast<unsigned char*>(data_), size_);
+}
+
+template<class T>
+auto ArrivalTrace::read(std::size_t offset) const -> T {
+    T value;
+    memcpy(&value, data_ + offset, sizeof(value));
+    return value;
+}
+
+auto ArrivalTrace::next_time() const -> double {
+    if (size_ - position_ < FLOW_SIZE) {
+        throw std::runtime_error("truncated flow in arrival trace");
+    }
+    return read<double>(position_);
+}
+
+auto ArrivalTrace::next() -> Flow {
+    if (size_ - position_ < FLOW_SIZE) {
+        throw std::runtime_error("truncated flow in arrival trace");
+    }
+
+    auto const flow = Flow{
+        read<double>(position_),
+        read<std::int32_t>(position_ + 8),
+        read<std::int32_t>(position_ + 12),
+        read<std::int32_t>(position_ + 16),
+        read<std::int32_t>(position_ + 20),
+    };
+    chunks_ = position_ + FLOW_SIZE;
+
+    auto const chunk_bytes = static_cast<std::size_t>(flow.num_chunks) * CHUNK_SIZE;
+    if (flow.num_chunks < 0 || size_ - chunks_ < chunk_bytes) {
+        throw std::runtime_error("truncated chunks in arrival trace");
+    }
+    position_ = chunks_ + chunk_bytes;
+
+    if (position_ - released_ >= 2 * RELEASE_STEP) {
+        release_consumed();
+    }
+    return flow;
+}
+
+auto ArrivalTrace::chunk(int index) const -> Chunk {
+    auto const offset = chunks_ + index * CHUNK_SIZE;
+    return Chunk{read<double>(offset), read<std::int32_t>(offset + 8)};
+}
+
+/*
+ * Drops the pages more than a step behind; the mapping is read-only, so
+ * touching them again would only fault them back in from the file.
+ */
+void ArrivalTrace::release_consumed() {
+    auto const page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    auto const end = (position_ - RELEASE_STEP) / page * page;
+    if (end > released_) {
+        madvise(const_cast<unsigned char*>(data_) + released_, end - released_,
+                MADV_DONTNEED);
+        released_ = end;
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef ns_arrival_trace_h
+#define ns_arrival_trace_h
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * Read side of a binary flow arrival trace, as written by
+ * scripts/congestion_runner/trace.py.  All values are little-endian:
+ *
+ *   "AFTRACE1"                                       8 byte magic
+ *   per flow, by non-decreasing time:
+ *     f64 time, i32 src, i32 dst, i32 size_bytes, i32 num_chunks
+ *     num_chunks times: f64 offset, i32 size_bytes, i32 reserved
+ *
+ * Chunk offsets are release times relative to the flow start; a flow
+ * without chunks is left to its application.
+ *
+ * The file is mapped read-only and walked front to back; pages already
+ * consumed are given back to the kernel every few megabytes, so the
+ * memory a replay needs does not grow with the length of the trace.
+ */
+class ArrivalTrace {
+public:
+    struct Flow {
+        double time;
+        int src;
+        int dst;
+        int size_bytes;
+        int num_chunks;
+    };
+
+    struct Chunk {
+        double offset;
+        int size_bytes;
+    };
+
+    /*
+     * Throws std::runtime_error if `path` cannot be mapped or is not a
+     * trace.
+     */
+    explicit ArrivalTrace(std::string const& path);
+    ~ArrivalTrace();
+
+    ArrivalTrace(ArrivalTrace const&) = delete;
+    auto operator=(ArrivalTrace const&) -> ArrivalTrace& = delete;
+
+    [[nodiscard]] auto done() const -> bool { return position_ == size_; }
+
+    /*
+     * Arrival time of the next flow; only valid while !done().  Throws
+     * std::runtime_error on a truncated record.
+     */
+    [[nodiscard]] auto next_time() const -> double;
+
+    /*
+     * Moves to the next flow and returns it; its chunks are available
+     * through chunk() until the following call.  Throws
+     * std::runtime_error on a truncated record.
+     */
+    auto next() -> Flow;
+
+    [[nodiscard]] auto chunk(int index) const -> Chunk;
+
+private:
+    template<class T>
+    auto read(std::size_t offset) const -> T;
+
+    void release_consumed();
+
+private:
+    static constexpr std::size_t FLOW_SIZE = 24;
+    static constexpr std::size_t CHUNK_SIZE = 16;
+
+    unsigned char const* data_;
+    std::size_t size_;
+    std::size_t position_;
+    std::size_t chunks_;        // offset of the current flow's chunks
+    std::size_t released_;      // bytes at the front given back
+};
+
+#endif
@@ -0,0 +1,82 @@
+#include "ColumnarLog.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <stdexcept>
+
+namespace {
+
+auto numpy_dtype(ColumnarLog::Type type) -> char const * {
+    switch (type) {
+    case ColumnarLog::Type::U8: return "|u1";
+    case ColumnarLog::Type::I16: return "<i2";
+    case ColumnarLog::Type::I32: return "<i4";
+    case ColumnarLog::Type::F64: return "<f8";
+    }
+    throw std::logic_error("unknown column type");
+}
+
+template<class T>
+void write_raw(FILE* file, T value) {
+    fwrite(&value, sizeof(value), 1, file);
+}
+
+}
+
+ColumnarLog::ColumnarLog(std::string const& directory, std::vector<Column> columns)
+    : columns_{std::move(columns)}
+    , files_{}
+{
+    namespace fs = std::filesystem;
+    fs::create_directories(directory);
+
+    auto const open = [&](std::string const& name) {
+        auto const file = fopen((fs::path(directory) / name).c_str(), "wb");
+        if (file == nullptr) {
+            throw std::runtime_error("cannot create " + directory + "/" + name);
+        }
+        return file;
+    };
+
+    auto const schema = open("schema.json");
+    fprintf(schema, "{\"columns\": [");
+    for (std::size_t i = 0; i < columns_.size(); ++i) {
+        fprintf(schema, "%s{\"name\": \"%s\", \"dtype\": \"%s\"}",
+                i == 0 ? "" : ", ", columns_[i].name.c_str(),
+                numpy_dtype(columns_[i].type));
+    }
+    fprintf(schema, "]}\n");
+    fclose(schema);
+
+    for (auto const& column : columns_) {
+        files_.push_back(open(column.name + ".bin"));
+    }
+}
+
+ColumnarLog::~ColumnarLog() {
+    for (auto const file : files_) {
+        fclose(file);
+    }
+}
+
+void ColumnarLog::flush() {
+    for (auto const file : files_) {
+        fflush(file);
+    }
+}
+
+void ColumnarLog::check_row_size(std::size_t size) const {
+    if (size != columns_.size()) {
+        throw std::logic_error("row does not match the log schema");
+    }
+}
+
+void ColumnarLog::write(std::size_t column, double value) {
+    auto const file = files_[column];
+    switch (columns_[column].type) {
+    case Type::U8: write_raw(file, static_cast<std::uint8_t>(value)); break;
+    case Type::I16: write_raw(file, static_cast<std::int16_t>(value)); break;
+    case Type::I32: write_raw(file, static_cast<std::int32_t>(value)); break;
+    case Type::F64: write_raw(file, value); break;
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef ns_columnar_log_h
+#define ns_columnar_log_h
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/*
+ * Fixed-schema binary log: a directory holding one raw little-endian
+ * file per column (<name>.bin) and a schema.json naming the numpy dtype
+ * of each, so scripts/plot_generation/binlog.py can numpy.memmap the
+ * columns instead of parsing text.  Rows are appended whole; a run that
+ * dies mid-row leaves columns of different lengths, which the reader
+ * truncates to the shortest.
+ */
+class ColumnarLog {
+public:
+    enum class Type { U8, I16, I32, F64 };
+
+    struct Column {
+        std::string name;
+        Type type;
+    };
+
+    /*
+     * Creates `directory` if needed and truncates its columns.  Throws
+     * std::runtime_error if a file cannot be created.
+     */
+    ColumnarLog(std::string const& directory, std::vector<Column> columns);
+    ~ColumnarLog();
+
+    ColumnarLog(ColumnarLog const&) = delete;
+    auto operator=(ColumnarLog const&) -> ColumnarLog& = delete;
+
+    /*
+     * Appends one row, one value per column in schema order.  Every value
+     * is converted to its column's type.
+     */
+    template<class... Values>
+    void append(Values... values) {
+        check_row_size(sizeof...(Values));
+        std::size_t column = 0;
+        (write(column++, static_cast<double>(values)), ...);
+    }
+
+    void flush();
+
+private:
+    void check_row_size(std::size_t size) const;
+    void write(std::size_t column, double value);
+
+private:
+    std::vector<Column> const columns_;
+    std::vector<FILE*> files_;
+};
+
+#endif
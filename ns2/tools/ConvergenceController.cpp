@@ -0,0 +1,178 @@
+#include "ConvergenceController.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <sstream>
+
+namespace {
+
+class ConvergenceControllerClass : public TclClass {
+public:
+    ConvergenceControllerClass() : TclClass("ConvergenceController") {}
+    auto create(int, const char *const* ) -> TclObject * override {
+        return new ConvergenceController{};
+    }
+} class_convergence_controller;
+
+auto parse_bound(std::string_view bound) -> std::optional<long> {
+    if (bound.empty()) {
+        return std::nullopt;
+    }
+    return atol(bound.data());
+}
+
+/*
+ * Two-sided 95% quantile of Student's t with dof degrees of freedom,
+ * by the Cornish-Fisher expansion around the normal quantile (within
+ * 0.3% from 5 degrees of freedom on).
+ */
+auto t_quantile_95(double dof) -> double {
+    constexpr auto z = 1.959963984540054;
+    auto const z3 = z * z * z;
+    auto const z5 = z3 * z * z;
+    auto const z7 = z5 * z * z;
+    return z
+        + (z3 + z) / (4 * dof)
+        + (5 * z5 + 16 * z3 + 3 * z) / (96 * dof * dof)
+        + (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / (384 * dof * dof * dof);
+}
+
+}
+
+ConvergenceController::ConvergenceController()
+    : batch_size_{0}
+    , min_batches_{0}
+    , min_flows_{0}
+    , precision_{0}
+    , num_flows_{0}
+    , metrics_{}
+{
+    bind("batch_size_", &batch_size_);
+    bind("min_batches_", &min_batches_);
+    bind("min_flows_", &min_flows_);
+    bind("precision_", &precision_);
+}
+
+auto ConvergenceController::command(int argc, char const * const * argv) -> int {
+    return nfp::command::dispatch(this, argc, argv)
+        .add("add-metric", &ConvergenceController::add_metric)
+        .add("report", &ConvergenceController::report)
+        .result([this] (auto argc, auto argv)
+                { return super::command(argc, argv); });
+}
+
+/*
+ * add-metric <lower> <upper> fct|nfct|realnfct mean|p99, with the flow
+ * size bounds in bytes (inclusive, empty for none).
+ */
+auto ConvergenceController::add_metric(std::string_view lower,
+        std::string_view upper, std::string_view value,
+        std::string_view statistic) -> nfp::command::TclResult {
+    auto& tcl = Tcl::instance();
+
+    Value v;
+    if (value == "fct") {
+        v = Value::FCT;
+    } else if (value == "nfct") {
+        v = Value::NFCT;
+    } else if (value == "realnfct") {
+        v = Value::REAL_NFCT;
+    } else {
+        tcl.resultf("add-metric: unknown value %s", value.data());
+        return nfp::command::TclResult::ERROR;
+    }
+
+    Statistic s;
+    if (statistic == "mean") {
+        s = Statistic::MEAN;
+    } else if (statistic == "p99") {
+        s = Statistic::P99;
+    } else {
+        tcl.resultf("add-metric: unknown statistic %s", statistic.data());
+        return nfp::command::TclResult::ERROR;
+    }
+
+    metrics_.push_back(Metric{parse_bound(lower), parse_bound(upper), v, s,
+            {}, 0, 0.0, 0.0});
+    return nfp::command::TclResult::OK;
+}
+
+/*
+ * One line per metric: batches, estimate and relative half-width.
+ */
+auto ConvergenceController::report() -> nfp::command::TclResult {
+    std::ostringstream buf{};
+    for (auto const& metric : metrics_) {
+        buf << metric.batches << " " << metric.mean << " "
+            << relative_half_width(metric) << "\n";
+    }
+    Tcl::instance().result(buf.str().c_str());
+    return nfp::command::TclResult::OK;
+}
+
+void ConvergenceController::add(FctStats::Flow const& flow) {
+    ++num_flows_;
+    for (auto& metric : metrics_) {
+        if ((metric.lower && flow.size_bytes < *metric.lower)
+                || (metric.upper && flow.size_bytes > *metric.upper)) {
+            continue;
+        }
+
+        switch (metric.value) {
+        case Value::FCT:
+            metric.batch.push_back(flow.fct);
+            break;
+        case Value::NFCT:
+            metric.batch.push_back(flow.fct / flow.size_bytes);
+            break;
+        case Value::REAL_NFCT:
+            metric.batch.push_back(flow.fct / flow.oracle_fct);
+            break;
+        }
+        if (static_cast<int>(metric.batch.size()) >= batch_size_) {
+            close_batch(metric);
+        }
+    }
+}
+
+void ConvergenceController::close_batch(Metric& metric) {
+    auto& batch = metric.batch;
+    double result;
+    if (metric.statistic == Statistic::MEAN) {
+        result = std::accumulate(begin(batch), end(batch), 0.0) / batch.size();
+    } else {
+        // result.py's index of the 99th percentile
+        auto const nth = begin(batch) + 99 * batch.size() / 100;
+        std::nth_element(begin(batch), nth, end(batch));
+        result = *nth;
+    }
+    batch.clear();
+
+    ++metric.batches;
+    auto const delta = result - metric.mean;
+    metric.mean += delta / metric.batches;
+    metric.m2 += delta * (result - metric.mean);
+}
+
+auto ConvergenceController::relative_half_width(Metric const& metric) const
+        -> double {
+    if (metric.batches < 2 || metric.mean == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    auto const dof = static_cast<double>(metric.batches - 1);
+    auto const stddev = std::sqrt(metric.m2 / dof);
+    return t_quantile_95(dof) * stddev / std::sqrt(double(metric.batches))
+        / std::abs(metric.mean);
+}
+
+auto ConvergenceController::converged() const -> bool {
+    if (metrics_.empty() || num_flows_ < static_cast<std::uint64_t>(min_flows_)) {
+        return false;
+    }
+    return std::all_of(begin(metrics_), end(metrics_), [this] (auto const& metric) {
+        return metric.batches >= static_cast<std::uint64_t>(min_batches_)
+            && relative_half_width(metric) <= precision_;
+    });
+}
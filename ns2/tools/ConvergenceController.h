@@ -0,0 +1,76 @@
+#ifndef ns_convergence_controller_h
+#define ns_convergence_controller_h
+
+#include <tools/CommandDispatchHelper.h>
+#include <tools/FctStats.h>
+#include <common/object.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/*
+ * Decides when a run has enough flows: every metric added with
+ * add-metric (the mean or 99th percentile of the FCT, normalised FCT or
+ * real nFCT of one flow size range, as in result.py) is estimated by
+ * batch means over the completion stream, and the run has converged
+ * once each estimate's 95% confidence interval is within precision_ of
+ * it (relative half-width).
+ *
+ * Consecutive flows of a range are grouped into batches of batch_size_;
+ * the batch results (batch mean, or batch 99th percentile) are treated
+ * as independent, so batches should be long compared with the
+ * correlation of the flow stream.  Nothing converges before min_flows_
+ * flows and min_batches_ batches per metric.
+ *
+ * TrafficMatrix feeds it (attach-convergence) the flows it counts
+ * towards flow_limit_, i.e. without the warm-up flows, and ends the run
+ * early once converged() holds.
+ */
+class ConvergenceController : public TclObject {
+    using super = TclObject;
+public:
+    ConvergenceController();
+
+    auto command(int argc, char const * const * argv) -> int override;
+
+    void add(FctStats::Flow const& flow);
+    [[nodiscard]] auto converged() const -> bool;
+    [[nodiscard]] auto num_flows() const -> std::uint64_t { return num_flows_; }
+
+private:
+    enum class Value { FCT, NFCT, REAL_NFCT };
+    enum class Statistic { MEAN, P99 };
+
+    struct Metric {
+        std::optional<long> lower;
+        std::optional<long> upper;
+        Value value;
+        Statistic statistic;
+        std::vector<double> batch;
+        // Welford's running mean and variance of the batch results
+        std::uint64_t batches;
+        double mean;
+        double m2;
+    };
+
+private:
+    auto add_metric(std::string_view lower, std::string_view upper,
+            std::string_view value, std::string_view statistic)
+            -> nfp::command::TclResult;
+    auto report() -> nfp::command::TclResult;
+
+    void close_batch(Metric& metric);
+    [[nodiscard]] auto relative_half_width(Metric const& metric) const -> double;
+
+private:
+    int batch_size_;
+    int min_batches_;
+    int min_flows_;
+    double precision_;
+    std::uint64_t num_flows_;
+    std::vector<Metric> metrics_;
+};
+
+#endif
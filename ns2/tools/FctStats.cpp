@@ -0,0 +1,215 @@
+#include "FctStats.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+auto bound_json(std::optional<long> bound) -> nlohmann::json {
+    return bound ? nlohmann::json(*bound) : nlohmann::json(nullptr);
+}
+
+auto sketch_json(QuantileSketch const& sketch) -> nlohmann::json {
+    auto buckets = nlohmann::json::array();
+    for (auto const [key, count] : sketch.buckets()) {
+        buckets.push_back({key, count});
+    }
+    return buckets;
+}
+
+/*
+ * result.py averages: inf for an empty set (written as null).
+ */
+auto average(double sum, std::uint64_t num) -> double {
+    return num > 0 ? sum / num : std::numeric_limits<double>::infinity();
+}
+
+}
+
+QuantileSketch::QuantileSketch(int precision)
+    : precision_{precision}
+    , count_{0}
+    , counts_{}
+{}
+
+void QuantileSketch::add(double value) {
+    if (!(value > 0) || !std::isfinite(value)) {
+        throw std::logic_error("QuantileSketch only holds positive values");
+    }
+    ++counts_[key(value)];
+    ++count_;
+}
+
+auto QuantileSketch::percentile(int percent) const -> double {
+    if (count_ == 0) {
+        return 0;
+    }
+
+    auto const rank = percent * count_ / 100;
+    std::uint64_t seen = 0;
+    for (auto const [key, count] : counts_) {
+        seen += count;
+        if (seen > rank) {
+            return midpoint(key);
+        }
+    }
+    return midpoint(counts_.rbegin()->first);
+}
+
+/*
+ * value = m 2^e with m in [0.5, 1); the key is e followed by the index
+ * of m's sub-bucket, so keys sort like the values.  e is negative for
+ * values below 0.5, hence arithmetic instead of shifts.
+ */
+auto QuantileSketch::key(double value) const -> int {
+    int exponent;
+    auto const mantissa = std::frexp(value, &exponent);
+    auto const sub = static_cast<int>(std::ldexp(mantissa - 0.5, precision_ + 1));
+    return exponent * (1 << precision_) + sub;
+}
+
+auto QuantileSketch::midpoint(int key) const -> double {
+    auto const buckets = 1 << precision_;
+    // floor division, so that sub is in [0, buckets)
+    auto exponent = key / buckets;
+    auto sub = key % buckets;
+    if (sub < 0) {
+        --exponent;
+        sub += buckets;
+    }
+    return std::ldexp(0.5 + std::ldexp(sub + 0.5, -(precision_ + 1)), exponent);
+}
+
+FctStats::Bucket::Bucket(std::string name, std::optional<long> lower,
+        std::optional<long> upper)
+    : name{std::move(name)}
+    , lower{lower}
+    , upper{upper}
+{}
+
+auto FctStats::Bucket::contains(long size) const -> bool {
+    return (!lower || size >= *lower) && (!upper || size <= *upper);
+}
+
+/*
+ * FlowSetStats.add.
+ */
+void FctStats::Bucket::add(Flow const& flow) {
+    auto const deadline = flow.deadline_us * 1e-6;
+    auto const has_deadline = flow.deadline_us != 0 || flow.early_terminated;
+    auto const deadline_met = flow.deadline_us != 0
+        && flow.fct <= deadline && !flow.early_terminated;
+    auto const gp = flow.size_bytes * 8 / flow.fct;
+    auto const normalized = flow.fct / flow.size_bytes;
+    auto const real_normalized = flow.fct / flow.oracle_fct;
+
+    ++num;
+    fct_sum += flow.fct;
+    nfct_sum += normalized;
+    real_nfct_sum += real_normalized;
+    gp_sum += gp;
+    fct.add(flow.fct);
+    nfct.add(normalized);
+    real_nfct.add(real_normalized);
+
+    if (!has_deadline) {
+        ++num_no_deadline;
+        nd_gp_sum += gp;
+    }
+    if (has_deadline) {
+        ++deadlines;
+    }
+    if (deadline_met) {
+        ++deadlines_met;
+    }
+    timeouts += flow.timeouts;
+}
+
+FctStats::FctStats()
+    : buckets_{}
+{
+    // the fixed sets of result.py
+    add_bucket("overall", std::nullopt, std::nullopt);
+    add_bucket("short", std::nullopt, 100 * 1024);
+    add_bucket("median", 100 * 1024 + 1, 10 * 1024 * 1024);
+    add_bucket("large", 10 * 1024 * 1024, std::nullopt);
+}
+
+void FctStats::add_bucket(std::string name, std::optional<long> lower,
+        std::optional<long> upper) {
+    buckets_.emplace_back(std::move(name), lower, upper);
+}
+
+void FctStats::add(Flow const& flow) {
+    for (auto& bucket : buckets_) {
+        if (bucket.contains(flow.size_bytes)) {
+            bucket.add(flow);
+        }
+    }
+}
+
+void FctStats::write(std::string const& path, double now, bool complete) const {
+    auto buckets = nlohmann::json::array();
+    for (auto const& b : buckets_) {
+        buckets.push_back({
+            {"name", b.name},
+            {"lower", bound_json(b.lower)},
+            {"upper", bound_json(b.upper)},
+            {"stats", {
+                {"num", b.num},
+                {"avgfct", average(b.fct_sum, b.num)},
+                {"gp", b.num > 0 ? b.gp_sum / b.num : 0},
+                {"nd_gp", b.num_no_deadline > 0 ? b.nd_gp_sum / b.num_no_deadline : 0},
+                {"tailfct", b.fct.percentile(99)},
+                {"medianfct", b.fct.percentile(50)},
+                {"thd", b.deadlines_met},
+                {"max_thd", b.deadlines},
+                {"thd_fraction", b.deadlines > 0
+                    ? nlohmann::json(double(b.deadlines_met) / b.deadlines)
+                    : nlohmann::json(nullptr)},
+                {"avgrealnfct", average(b.real_nfct_sum, b.num)},
+                {"tailavgrealnfct", b.real_nfct.percentile(99)},
+                {"avgnfct", average(b.nfct_sum, b.num)},
+                {"tailnfct", b.nfct.percentile(99)},
+                {"numtos", b.timeouts},
+            }},
+            {"state", {
+                {"num", b.num},
+                {"num_no_deadline", b.num_no_deadline},
+                {"deadlines", b.deadlines},
+                {"deadlines_met", b.deadlines_met},
+                {"timeouts", b.timeouts},
+                {"fct_sum", b.fct_sum},
+                {"nfct_sum", b.nfct_sum},
+                {"real_nfct_sum", b.real_nfct_sum},
+                {"gp_sum", b.gp_sum},
+                {"nd_gp_sum", b.nd_gp_sum},
+                {"fct", sketch_json(b.fct)},
+                {"nfct", sketch_json(b.nfct)},
+                {"real_nfct", sketch_json(b.real_nfct)},
+            }},
+        });
+    }
+
+    auto const summary = nlohmann::json{
+        {"time", now},
+        {"complete", complete},
+        {"precision", PRECISION},
+        {"buckets", std::move(buckets)},
+    };
+
+    auto const tmp = path + ".tmp";
+    {
+        std::ofstream out{tmp};
+        out << summary.dump() << '\n';
+        if (!out) {
+            throw std::runtime_error("cannot write " + tmp);
+        }
+    }
+    std::filesystem::rename(tmp, path);
+}
@@ -0,0 +1,118 @@
+#ifndef ns_fct_stats_h
+#define ns_fct_stats_h
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+/*
+ * Log-linear histogram of positive values (an HDR histogram without a
+ * fixed range): a value falls into one of 2^precision equal sub-buckets
+ * of its power-of-two interval, so a quantile is known to a relative
+ * error of 2^-(precision + 1) whatever the magnitude.  Only non-empty
+ * buckets are stored, and two histograms of the same precision merge by
+ * adding their counts per key.
+ */
+class QuantileSketch {
+public:
+    explicit QuantileSketch(int precision);
+
+    void add(double value);
+
+    [[nodiscard]] auto count() const -> std::uint64_t { return count_; }
+
+    /*
+     * The value of rank percent * count / 100 (0-based, rounded down) in
+     * sorted order, as result.py indexes its sorted lists, or 0 if the
+     * sketch is empty.
+     */
+    [[nodiscard]] auto percentile(int percent) const -> double;
+
+    [[nodiscard]] auto buckets() const -> std::map<int, std::uint64_t> const& {
+        return counts_;
+    }
+
+private:
+    [[nodiscard]] auto key(double value) const -> int;
+    [[nodiscard]] auto midpoint(int key) const -> double;
+
+private:
+    int const precision_;
+    std::uint64_t count_;
+    std::map<int, std::uint64_t> counts_;
+};
+
+/*
+ * Streaming version of the FlowSetStats of
+ * scripts/plot_generation/result.py: per flow-size bucket the sums behind
+ * the averages, the deadline and timeout counts and a QuantileSketch per
+ * percentile metric, so the same summary is available without keeping or
+ * parsing the per-flow log.
+ *
+ * Buckets are inclusive byte ranges like result.py's Bound and overlap
+ * freely; overall, short, median and large are always present.
+ *
+ * write() stores the derived statistics under the result.py --json keys
+ * together with the mergeable state, which
+ * scripts/plot_generation/fct_summary.py combines across runs.
+ */
+class FctStats {
+public:
+    struct Flow {
+        double fct;
+        double oracle_fct;
+        int size_bytes;
+        int timeouts;
+        int deadline_us;
+        bool early_terminated;
+    };
+
+    static constexpr int PRECISION = 7;
+
+    FctStats();
+
+    void add_bucket(std::string name, std::optional<long> lower,
+            std::optional<long> upper);
+
+    void add(Flow const& flow);
+
+    /*
+     * Replaces `path` with the summary as of simulated time `now`, via a
+     * rename so a reader never sees half a file.  Throws
+     * std::runtime_error if it cannot be written.
+     */
+    void write(std::string const& path, double now, bool complete) const;
+
+private:
+    struct Bucket {
+        Bucket(std::string name, std::optional<long> lower,
+                std::optional<long> upper);
+
+        std::string name;
+        std::optional<long> lower;
+        std::optional<long> upper;
+        std::uint64_t num = 0;
+        std::uint64_t num_no_deadline = 0;
+        std::uint64_t deadlines = 0;
+        std::uint64_t deadlines_met = 0;
+        std::uint64_t timeouts = 0;
+        double fct_sum = 0;
+        double nfct_sum = 0;
+        double real_nfct_sum = 0;
+        double gp_sum = 0;
+        double nd_gp_sum = 0;
+        QuantileSketch fct{PRECISION};
+        QuantileSketch nfct{PRECISION};
+        QuantileSketch real_nfct{PRECISION};
+
+        [[nodiscard]] auto contains(long size) const -> bool;
+        void add(Flow const& flow);
+    };
+
+private:
+    std::vector<Bucket> buckets_;
+};
+
+#endif
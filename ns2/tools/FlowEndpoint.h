@@ -0,0 +1,53 @@
+#ifndef ns_flow_endpoint_h
+#define ns_flow_endpoint_h
+
+class FlowEndpoint;
+
+/*
+ * Told by the sending agent when the flow it was given has been fully
+ * acknowledged.
+ */
+class FlowObserver {
+public:
+    virtual ~FlowObserver() = default;
+    virtual void flow_finished(FlowEndpoint& sender) = 0;
+};
+
+/*
+ * What a native traffic source (TrafficMatrix) needs from a transport
+ * agent: the per-flow variables TCP_pair sets and reads through Tcl, and
+ * a completion callback that replaces the Tcl done_data proc.
+ */
+class FlowEndpoint {
+public:
+    virtual ~FlowEndpoint() = default;
+
+    void set_flow_observer(FlowObserver* observer) { flow_observer_ = observer; }
+
+    // sender: size of the whole flow (true_flow_size_)
+    virtual void set_true_flow_size(int bytes) = 0;
+    // receiver: bytes still to arrive (flow_remaining_)
+    virtual void set_flow_remaining(int bytes) = 0;
+
+    [[nodiscard]] virtual auto retransmit_timeouts() const -> int = 0;
+    [[nodiscard]] virtual auto flow_deadline() const -> int = 0;
+    [[nodiscard]] virtual auto flow_early_terminated() const -> int = 0;
+
+protected:
+    /*
+     * Returns false if no observer is attached, in which case the agent
+     * falls back to invoking done_data in Tcl.
+     */
+    auto notify_flow_finished() -> bool {
+        if (flow_observer_ == nullptr) {
+            return false;
+        }
+        flow_observer_->flow_finished(*this);
+        return true;
+    }
+
+private:
+    FlowObserver* flow_observer_ = nullptr;
+};
+
+#endif
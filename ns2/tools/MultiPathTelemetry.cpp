@@ -0,0 +1,152 @@
+#include "MultiPathTelemetry.h"
+
+#include <common/ip.h>
+#include <common/packet.h>
+
+#include <stdexcept>
+
+namespace {
+
+class MultiPathTelemetryClass : public TclClass {
+public:
+    MultiPathTelemetryClass() : TclClass("MultiPathTelemetry") {}
+    auto create(int, const char *const* ) -> TclObject * override {
+        return new MultiPathTelemetry{};
+    }
+} class_multipath_telemetry;
+
+}
+
+MultiPathTelemetry* MultiPathTelemetry::active_ = nullptr;
+
+MultiPathTelemetry::MultiPathTelemetry()
+    : interval_{0}
+    , uplinks_{}
+    , series_{}
+    , paths_{}
+    , timer_{*this}
+{
+    bind("interval_", &interval_);
+}
+
+MultiPathTelemetry::~MultiPathTelemetry() {
+    if (active_ == this) {
+        active_ = nullptr;
+    }
+}
+
+auto MultiPathTelemetry::command(int argc, char const * const * argv) -> int {
+    return nfp::command::dispatch(this, argc, argv)
+        .add("start", &MultiPathTelemetry::start_series)
+        .add("start", &MultiPathTelemetry::start)
+        .add("stop", &MultiPathTelemetry::stop)
+        .result([this] (auto argc, auto argv)
+                { return super::command(argc, argv); });
+}
+
+auto MultiPathTelemetry::start_series(std::string_view series)
+        -> nfp::command::TclResult {
+    return start(series, "");
+}
+
+/*
+ * start <series directory> [<paths directory>]: starts counting and
+ * sampling; there can be only one started instance.
+ */
+auto MultiPathTelemetry::start(std::string_view series, std::string_view paths)
+        -> nfp::command::TclResult {
+    auto& tcl = Tcl::instance();
+    if (active_ != nullptr) {
+        tcl.resultf("start: %s is already running", active_->name());
+        return nfp::command::TclResult::ERROR;
+    }
+    if (interval_ <= 0) {
+        tcl.resultf("start: interval_ must be positive");
+        return nfp::command::TclResult::ERROR;
+    }
+
+    using Type = ColumnarLog::Type;
+    try {
+        series_ = std::make_unique<ColumnarLog>(std::string{series},
+                std::vector<ColumnarLog::Column>{
+                    {"time", Type::F64},
+                    {"node", Type::I32},
+                    {"next_hop", Type::I32},
+                    {"bytes", Type::F64},
+                    {"packets", Type::F64},
+                    {"flows", Type::I32},
+                });
+        if (!paths.empty()) {
+            paths_ = std::make_unique<ColumnarLog>(std::string{paths},
+                    std::vector<ColumnarLog::Column>{
+                        {"time", Type::F64},
+                        {"node", Type::I32},
+                        {"next_hop", Type::I32},
+                        {"src", Type::I32},
+                        {"dst", Type::I32},
+                        {"fid", Type::I32},
+                    });
+        }
+    } catch (std::runtime_error const& e) {
+        series_.reset();
+        tcl.resultf("start: %s", e.what());
+        return nfp::command::TclResult::ERROR;
+    }
+
+    active_ = this;
+    timer_.resched(interval_);
+    return nfp::command::TclResult::OK;
+}
+
+/*
+ * Takes a last sample of the interval so far and flushes the logs.
+ */
+auto MultiPathTelemetry::stop() -> nfp::command::TclResult {
+    if (active_ != this) {
+        return nfp::command::TclResult::OK;
+    }
+    timer_.force_cancel();
+    sample();
+    series_->flush();
+    if (paths_) {
+        paths_->flush();
+    }
+    active_ = nullptr;
+    return nfp::command::TclResult::OK;
+}
+
+auto MultiPathTelemetry::uplink(int node, int next_hop) -> Uplink& {
+    auto const key = std::make_pair(node, next_hop);
+    auto it = uplinks_.find(key);
+    if (it == end(uplinks_)) {
+        it = uplinks_.emplace(key, Uplink{node, next_hop, 0, 0, {}}).first;
+    }
+    return it->second;
+}
+
+void MultiPathTelemetry::count(Uplink& uplink, Packet* packet,
+        unsigned int flow_hash) {
+    uplink.bytes += hdr_cmn::access(packet)->size();
+    ++uplink.packets;
+    if (uplink.flows.insert(flow_hash).second && paths_) {
+        auto const iph = hdr_ip::access(packet);
+        paths_->append(Scheduler::instance().clock(), uplink.node,
+                uplink.next_hop, iph->saddr(), iph->daddr(), iph->flowid());
+    }
+}
+
+void MultiPathTelemetry::sample() {
+    auto const now = Scheduler::instance().clock();
+    for (auto& [key, uplink] : uplinks_) {
+        series_->append(now, uplink.node, uplink.next_hop, uplink.bytes,
+                uplink.packets, uplink.flows.size());
+        uplink.bytes = 0;
+        uplink.packets = 0;
+        uplink.flows.clear();
+    }
+}
+
+void MultiPathTelemetry::SampleTimer::expire(Event*) {
+    telemetry_.sample();
+    resched(telemetry_.interval_);
+}
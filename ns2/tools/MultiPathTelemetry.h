@@ -0,0 +1,86 @@
+#ifndef ns_multipath_telemetry_h
+#define ns_multipath_telemetry_h
+
+#include <tools/ColumnarLog.h>
+#include <tools/CommandDispatchHelper.h>
+#include <common/object.h>
+#include <common/timer-handler.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+
+/*
+ * How the multipath classifiers (Classifier/MultiPath) spread traffic:
+ * bytes, packets and distinct flows per node and uplink (next hop),
+ * sampled every interval_ seconds into a ColumnarLog with columns
+ * time, node, next_hop, bytes, packets, flows.  Counts are per interval
+ * and every uplink seen so far gets a row per sample, idle or not.
+ *
+ * Optionally, the path of each flow goes to a second ColumnarLog with
+ * columns time, node, next_hop, src, dst, fid: a row whenever a flow
+ * first shows on an uplink within an interval, so a flow that stays on
+ * its path gets one row per hop and interval.
+ *
+ * Only the started instance counts; the classifiers only pay for a null
+ * check while none is.
+ */
+class MultiPathTelemetry : public TclObject {
+    using super = TclObject;
+public:
+    struct Uplink {
+        int node;
+        int next_hop;
+        std::uint64_t bytes;
+        std::uint64_t packets;
+        std::unordered_set<unsigned int> flows;   // seen this interval
+    };
+
+    MultiPathTelemetry();
+    ~MultiPathTelemetry() override;
+
+    auto command(int argc, char const * const * argv) -> int override;
+
+    /*
+     * The started instance, nullptr if none.
+     */
+    [[nodiscard]] static auto active() -> MultiPathTelemetry* { return active_; }
+
+    /*
+     * Counters of the uplink from node to next_hop; the reference stays
+     * valid for the lifetime of this object.
+     */
+    auto uplink(int node, int next_hop) -> Uplink&;
+
+    void count(Uplink& uplink, Packet* packet, unsigned int flow_hash);
+
+private:
+    class SampleTimer : public TimerHandler {
+    public:
+        explicit SampleTimer(MultiPathTelemetry& telemetry) : telemetry_{telemetry} {}
+    protected:
+        void expire(Event*) override;
+    private:
+        MultiPathTelemetry& telemetry_;
+    };
+
+    auto start_series(std::string_view series) -> nfp::command::TclResult;
+    auto start(std::string_view series, std::string_view paths)
+            -> nfp::command::TclResult;
+    auto stop() -> nfp::command::TclResult;
+
+    void sample();
+
+private:
+    static MultiPathTelemetry* active_;
+
+    double interval_;
+    std::map<std::pair<int, int>, Uplink> uplinks_;
+    std::unique_ptr<ColumnarLog> series_;
+    std::unique_ptr<ColumnarLog> paths_;
+    SampleTimer timer_;
+};
+
+#endif
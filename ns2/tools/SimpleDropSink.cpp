@@ -1,6 +1,7 @@
 #include "SimpleDropSink.h"
 
 #include <common/ip.h>
+#include <tools/ColumnarLog.h>
 
 #include <sstream>
 
@@ -23,6 +24,7 @@ SimpleDropSink::SimpleDropSink()
 auto SimpleDropSink::command(int argc, char const * const * argv) -> int {
     return nfp::command::dispatch(this, argc, argv)
         .add("print-stats", &SimpleDropSink::print_stats)
+        .add("write-binlog", &SimpleDropSink::write_binlog)
         .result([this] (auto argc, auto argv) 
                 { return super::command(argc, argv); });
 }
@@ -47,6 +49,23 @@ auto SimpleDropSink::print_stats(std::string_view channel_name)
     return nfp::command::TclResult::OK;
 }
 
+auto SimpleDropSink::write_binlog(std::string_view directory)
+        -> nfp::command::TclResult {
+    try {
+        auto log = ColumnarLog{std::string{directory}, {
+            {"fid", ColumnarLog::Type::I32},
+            {"drops", ColumnarLog::Type::I32},
+        }};
+        for (auto [fid, cnt] : per_fid_counts_) {
+            log.append(fid, cnt);
+        }
+    } catch (std::runtime_error const& e) {
+        Tcl::instance().resultf("write-binlog: %s", e.what());
+        return nfp::command::TclResult::ERROR;
+    }
+    return nfp::command::TclResult::OK;
+}
+
 void SimpleDropSink::recv(Packet * packet, Handler *) {
     auto const iph = hdr_ip::access(packet);
     per_fid_counts_[iph->flowid()]++;
@@ -15,6 +15,8 @@ public:
 
 private:
     auto print_stats(std::string_view channel_name) -> nfp::command::TclResult;
+    // the same counts as a ColumnarLog with columns fid and drops
+    auto write_binlog(std::string_view directory) -> nfp::command::TclResult;
 
 private:
     std::unordered_map<int, int> per_fid_counts_;
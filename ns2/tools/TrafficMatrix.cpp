@@ -0,0 +1,616 @@
+#include "TrafficMatrix.h"
+
+#include "ConvergenceController.h"
+#include "app-chunks.h"
+#include "ranvar.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <optional>
+
+namespace {
+
+constexpr auto PACKET_SIZE = 1460;
+constexpr auto HEADER_SIZE = 40;
+
+class TrafficMatrixClass : public TclClass {
+public:
+    TrafficMatrixClass() : TclClass("TrafficMatrix") {}
+    auto create(int, const char *const* ) -> TclObject * override {
+        return new TrafficMatrix{};
+    }
+} class_traffic_matrix;
+
+/*
+ * The Tcl scheduler read its variables through "$rv value", which prints
+ * them with %6e; rounding the same way keeps the arrival times and flow
+ * sizes identical to the Tcl runs.
+ */
+auto tcl_value(RandomVariable& rv) -> double {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%6e", rv.value());
+    return strtod(buf, nullptr);
+}
+
+auto tcl_double(double value) -> std::string {
+    char buf[TCL_DOUBLE_SPACE];
+    Tcl_PrintDouble(Tcl::instance().interp(), value, buf);
+    return buf;
+}
+
+/*
+ * A summary bucket bound in bytes; empty for none.
+ */
+auto parse_bound(std::string_view bound) -> std::optional<long> {
+    if (bound.empty()) {
+        return std::nullopt;
+    }
+    return atol(bound.data());
+}
+
+template<class T>
+auto lookup_as(std::string_view name) -> T* {
+    return dynamic_cast<T*>(TclObject::lookup(name.data()));
+}
+
+}
+
+class TrafficMatrix::ArrivalEvent : public Event {
+public:
+    enum class Kind { START, CHECK_IF_BEHIND, POOL_ARRIVAL, SUMMARY, REPLAY };
+
+    ArrivalEvent(Kind kind, int group, int pair, int bytes)
+        : kind{kind}, group{group}, pair{pair}, bytes{bytes} {}
+
+    Kind const kind;
+    int const group;
+    int const pair;
+    int const bytes;
+};
+
+TrafficMatrix::TrafficMatrix()
+    : flow_limit_{0}
+    , count_after_{0}
+    , link_rate_{0}
+    , pool_{0}
+    , summary_interval_{0}
+    , flow_gen_{0}
+    , flow_fin_{0}
+    , logfile_{nullptr}
+    , binlog_{}
+    , stats_{}
+    , summary_path_{}
+    , convergence_{nullptr}
+    , trace_{}
+    , replay_chunks_{}
+    , replay_start_{-1}
+    , replayed_{0}
+    , host_groups_{}
+    , groups_{}
+    , senders_{}
+{
+    bind("flow_limit_", &flow_limit_);
+    bind("count_after_", &count_after_);
+    bind("link_rate_", &link_rate_);
+    bind_bool("pool_", &pool_);
+    bind("summary_interval_", &summary_interval_);
+}
+
+auto TrafficMatrix::command(int argc, char const * const * argv) -> int {
+    return nfp::command::dispatch(this, argc, argv)
+        .add("attach-logfile", &TrafficMatrix::attach_logfile)
+        .add("attach-binlog", &TrafficMatrix::attach_binlog)
+        .add("attach-summary", &TrafficMatrix::attach_summary)
+        .add("add-summary-bucket", &TrafficMatrix::add_summary_bucket)
+        .add("attach-convergence", &TrafficMatrix::attach_convergence)
+        .add("replay", &TrafficMatrix::replay)
+        .add("add-group", &TrafficMatrix::add_group)
+        .add("add-pair", &TrafficMatrix::add_pair)
+        .add("start-group", &TrafficMatrix::start_group)
+        .result([this] (auto argc, auto argv)
+                { return super::command(argc, argv); });
+}
+
+auto TrafficMatrix::attach_logfile(std::string_view channel_name)
+        -> nfp::command::TclResult {
+    auto& tcl = Tcl::instance();
+    int mode;
+    logfile_ = Tcl_GetChannel(tcl.interp(), channel_name.data(), &mode);
+
+    if (logfile_ == nullptr || !(mode & TCL_WRITABLE)) {
+        logfile_ = nullptr;
+        tcl.resultf("attach-logfile: can't write to %s", channel_name.data());
+        return nfp::command::TclResult::ERROR;
+    }
+    return nfp::command::TclResult::OK;
+}
+
+auto TrafficMatrix::attach_binlog(std::string_view directory)
+        -> nfp::command::TclResult {
+    using Type = ColumnarLog::Type;
+    try {
+        binlog_ = std::make_unique<ColumnarLog>(std::string{directory},
+                std::vector<ColumnarLog::Column>{
+                    {"size_pkts", Type::I32},
+                    {"fct", Type::F64},
+                    {"timeouts", Type::I16},
+                    {"src", Type::I16},
+                    {"dst", Type::I16},
+                    {"pid", Type::I32},
+                    {"deadline_us", Type::I32},
+                    {"early_terminated", Type::U8},
+                    {"oracle_fct", Type::F64},
+                });
+    } catch (std::runtime_error const& e) {
+        Tcl::instance().resultf("attach-binlog: %s", e.what());
+        return nfp::command::TclResult::ERROR;
+    }
+    return nfp::command::TclResult::OK;
+}
+
+auto TrafficMatrix::attach_summary(std::string_view path)
+        -> nfp::command::TclResult {
+    stats_ = std::make_unique<FctStats>();
+    summary_path_ = path;
+    if (summary_interval_ > 0) {
+        Scheduler::instance().schedule(this,
+                new ArrivalEvent{ArrivalEvent::Kind::SUMMARY, -1, -1, 0},
+                summary_interval_);
+    }
+    return nfp::command::TclResult::OK;
+}
+
+auto TrafficMatrix::add_summary_bucket(std::string_view name,
+        std::string_view lower, std::string_view upper)
+        -> nfp::command::TclResult {
+    if (!stats_) {
+        Tcl::instance().resultf("add-summary-bucket: no summary attached");
+        return nfp::command::TclResult::ERROR;
+    }
+    stats_->add_bucket(std::string{name}, parse_bound(lower), parse_bound(upper));
+    return nfp::command::TclResult::OK;
+}
+
+auto TrafficMatrix::attach_convergence(std::string_view controller)
+        -> nfp::command::TclResult {
+    convergence_ = lookup_as<ConvergenceController>(controller);
+    if (convergence_ == nullptr) {
+        Tcl::instance().resultf("attach-convergence: %s is no ConvergenceController",
+                controller.data());
+        return nfp::command::TclResult::ERROR;
+    }
+    return nfp::command::TclResult::OK;
+}
+
+auto TrafficMatrix::replay(std::string_view path) -> nfp::command::TclResult {
+    try {
+        trace_ = std::make_unique<ArrivalTrace>(std::string{path});
+    } catch (std::runtime_error const& e) {
+        Tcl::instance().resultf("replay: %s", e.what());
+        return nfp::command::TclResult::ERROR;
+    }
+    return nfp::command::TclResult::OK;
+}
+
+auto TrafficMatrix::add_group(std::string_view aggr, std::string_view group_id,
+        std::string_view flow_intval, std::string_view nbytes,
+        std::string_view path_rtt)
+        -> nfp::command::TclResult {
+    auto& tcl = Tcl::instance();
+    auto const flow_intval_rv = lookup_as<RandomVariable>(flow_intval);
+    auto const nbytes_rv = lookup_as<RandomVariable>(nbytes);
+
+    if (flow_intval_rv == nullptr || nbytes_rv == nullptr) {
+        tcl.resultf("add-group: %s and %s must be RandomVariables",
+                flow_intval.data(), nbytes.data());
+        return nfp::command::TclResult::ERROR;
+    }
+
+    int src = -1, dst = -1;
+    sscanf(group_id.data(), "%d %d", &src, &dst);
+
+    groups_.push_back(Group{std::string{aggr}, std::string{group_id}, src, dst,
+            flow_intval_rv, nbytes_rv, atof(path_rtt.data()), 0.0, {}, {}});
+    tcl.resultf("%d", static_cast<int>(groups_.size()) - 1);
+    return nfp::command::TclResult::OK;
+}
+
+auto TrafficMatrix::add_pair(std::string_view group, std::string_view tcps,
+        std::string_view tcpr, std::string_view apps)
+        -> nfp::command::TclResult {
+    auto& tcl = Tcl::instance();
+    auto const g = atoi(group.data());
+    auto const sender = lookup_as<FlowEndpoint>(tcps);
+    auto const receiver = lookup_as<FlowEndpoint>(tcpr);
+    auto const app = lookup_as<Application>(apps);
+
+    if (g < 0 || g >= static_cast<int>(groups_.size())) {
+        tcl.resultf("add-pair: no group %s", group.data());
+        return nfp::command::TclResult::ERROR;
+    }
+    if (sender == nullptr || receiver == nullptr || app == nullptr) {
+        tcl.resultf("add-pair: %s/%s do not support native flows",
+                tcps.data(), tcpr.data());
+        return nfp::command::TclResult::ERROR;
+    }
+
+    auto& pairs = groups_[g].pairs;
+    auto const pid = static_cast<int>(pairs.size());
+    pairs.push_back(Pair{sender, receiver, app,
+            dynamic_cast<ChunksApplication*>(app), 0.0, 0, 0});
+    senders_[sender] = {g, pid};
+    sender->set_flow_observer(this);
+
+    tcl.resultf("%d", pid);
+    return nfp::command::TclResult::OK;
+}
+
+/*
+ * Agent_Aggr_pair init_schedule: the first arrival of the group is one
+ * inter-arrival time from now, then every pair is scheduled in turn (or
+ * put on the free list, with pool_).
+ */
+auto TrafficMatrix::start_group(std::string_view group) -> nfp::command::TclResult {
+    auto const g = atoi(group.data());
+    if (g < 0 || g >= static_cast<int>(groups_.size())) {
+        Tcl::instance().resultf("start-group: no group %s", group.data());
+        return nfp::command::TclResult::ERROR;
+    }
+
+    auto& grp = groups_[g];
+    if (trace_) {
+        for (int pid = static_cast<int>(grp.pairs.size()) - 1; pid >= 0; --pid) {
+            grp.idle.push_back(pid);
+        }
+        host_groups_[{grp.src, grp.dst}] = g;
+        if (replay_start_ < 0) {
+            replay_start_ = Scheduler::instance().clock();
+            schedule_replay();
+        }
+        return nfp::command::TclResult::OK;
+    }
+
+    grp.tnext = Scheduler::instance().clock() + tcl_value(*grp.flow_intval);
+    if (pool_) {
+        // popped from the back, so pair 0 serves the first flow
+        for (int pid = static_cast<int>(grp.pairs.size()) - 1; pid >= 0; --pid) {
+            grp.idle.push_back(pid);
+        }
+        schedule_arrival(g);
+    } else {
+        for (int pid = 0; pid < static_cast<int>(grp.pairs.size()); ++pid) {
+            schedule(g, pid);
+        }
+    }
+    return nfp::command::TclResult::OK;
+}
+
+void TrafficMatrix::schedule(int group, int pair) {
+    if (flow_gen_ >= flow_limit_) {
+        return;
+    }
+
+    auto& scheduler = Scheduler::instance();
+    auto& grp = groups_[group];
+    auto const now = scheduler.clock();
+
+    if (now > grp.tnext) {
+        Tcl::instance().evalf(
+                "puts \"Error, Not enough flows ! Aborting! pair id %d\"; "
+                "flush stdout; exit", pair);
+        return;
+    }
+
+    auto const bytes = static_cast<int>(std::ceil(tcl_value(*grp.nbytes))) * PACKET_SIZE;
+    scheduler.schedule(this,
+            new ArrivalEvent{ArrivalEvent::Kind::START, group, pair, bytes},
+            grp.tnext - now);
+
+    grp.tnext += tcl_value(*grp.flow_intval);
+    scheduler.schedule(this,
+            new ArrivalEvent{ArrivalEvent::Kind::CHECK_IF_BEHIND, group, -1, 0},
+            grp.tnext - 0.0000001 - now);
+}
+
+/*
+ * pool_: draws the next flow of the group in the same order as
+ * schedule, but leaves the choice of pair to the arrival itself.
+ */
+void TrafficMatrix::schedule_arrival(int group) {
+    if (flow_gen_ >= flow_limit_) {
+        return;
+    }
+
+    auto& scheduler = Scheduler::instance();
+    auto& grp = groups_[group];
+
+    auto const bytes = static_cast<int>(std::ceil(tcl_value(*grp.nbytes))) * PACKET_SIZE;
+    scheduler.schedule(this,
+            new ArrivalEvent{ArrivalEvent::Kind::POOL_ARRIVAL, group, -1, bytes},
+            grp.tnext - scheduler.clock());
+    grp.tnext += tcl_value(*grp.flow_intval);
+}
+
+void TrafficMatrix::pool_arrival(int group, int bytes) {
+    auto& idle = groups_[group].idle;
+    int pair;
+    if (idle.empty()) {
+        pair = new_pair(group);
+    } else {
+        pair = idle.back();
+        idle.pop_back();
+    }
+    start_flow(group, pair, bytes);
+    schedule_arrival(group);
+}
+
+/*
+ * Has Tcl build one more connection for the group (Agent_Aggr_pair
+ * add-native-pair registers it through add-pair).
+ */
+auto TrafficMatrix::new_pair(int group) -> int {
+    Tcl::instance().evalf("%s add-native-pair", groups_[group].aggr.c_str());
+    return static_cast<int>(groups_[group].pairs.size()) - 1;
+}
+
+void TrafficMatrix::handle(Event* event) {
+    auto const arrival = static_cast<ArrivalEvent*>(event);
+    switch (arrival->kind) {
+    case ArrivalEvent::Kind::START:
+        start_flow(arrival->group, arrival->pair, arrival->bytes);
+        break;
+    case ArrivalEvent::Kind::CHECK_IF_BEHIND:
+        check_if_behind(arrival->group);
+        break;
+    case ArrivalEvent::Kind::POOL_ARRIVAL:
+        pool_arrival(arrival->group, arrival->bytes);
+        break;
+    case ArrivalEvent::Kind::REPLAY:
+        replay_arrivals();
+        break;
+    case ArrivalEvent::Kind::SUMMARY:
+        write_summary(false);
+        Scheduler::instance().schedule(this,
+                new ArrivalEvent{ArrivalEvent::Kind::SUMMARY, -1, -1, 0},
+                summary_interval_);
+        break;
+    }
+    delete arrival;
+}
+
+/*
+ * TCP_pair start, without the per-flow debug output.
+ */
+void TrafficMatrix::start_flow(int group, int pair, int bytes) {
+    if (begin_flow(group, pair, bytes)) {
+        groups_[group].pairs[pair].apps->send(bytes);
+    }
+}
+
+/*
+ * Everything of start_flow but the send; false if flow_limit_ was
+ * reached and the flow must not be sent.
+ */
+auto TrafficMatrix::begin_flow(int group, int pair, int bytes) -> bool {
+    auto& p = groups_[group].pairs[pair];
+    p.start_time = Scheduler::instance().clock();
+    p.bytes = bytes;
+
+    if (flow_gen_ >= flow_limit_) {
+        return false;
+    }
+    if (p.start_time >= count_after_) {
+        ++flow_gen_;
+    }
+
+    p.tcps->set_true_flow_size(bytes);
+    p.tcpr->set_flow_remaining(bytes);
+    return true;
+}
+
+/*
+ * Schedules the next arrival of the trace or, once it is exhausted,
+ * lets the run end with the last replayed flow.
+ */
+void TrafficMatrix::schedule_replay() {
+    if (flow_gen_ >= flow_limit_) {
+        return;
+    }
+    if (trace_->done()) {
+        flow_limit_ = replayed_;
+        if (flow_fin_ >= flow_limit_) {
+            end_run();
+        }
+        return;
+    }
+
+    auto& scheduler = Scheduler::instance();
+    auto next_time = 0.0;
+    try {
+        next_time = trace_->next_time();
+    } catch (std::runtime_error const& e) {
+        Tcl::instance().evalf("puts \"Error, %s ! Aborting!\"; flush stdout; exit 1",
+                e.what());
+        return;
+    }
+    auto const delay = replay_start_ + next_time - scheduler.clock();
+    scheduler.schedule(this,
+            new ArrivalEvent{ArrivalEvent::Kind::REPLAY, -1, -1, 0},
+            std::max(delay, 0.0));
+}
+
+/*
+ * Starts every flow of the trace that is due, with one event for all
+ * flows arriving at the same time.
+ */
+void TrafficMatrix::replay_arrivals() {
+    auto const now = Scheduler::instance().clock();
+    try {
+        do {
+            replay_flow(trace_->next());
+        } while (!trace_->done() && flow_gen_ < flow_limit_
+                && replay_start_ + trace_->next_time() <= now);
+    } catch (std::runtime_error const& e) {
+        Tcl::instance().evalf("puts \"Error, %s ! Aborting!\"; flush stdout; exit 1",
+                e.what());
+        return;
+    }
+    schedule_replay();
+}
+
+void TrafficMatrix::replay_flow(ArrivalTrace::Flow const& flow) {
+    auto const found = host_groups_.find({flow.src, flow.dst});
+    if (found == host_groups_.end()) {
+        throw std::runtime_error("no connections from host "
+                + std::to_string(flow.src) + " to " + std::to_string(flow.dst));
+    }
+    auto const group = found->second;
+
+    auto& idle = groups_[group].idle;
+    int pair;
+    if (idle.empty()) {
+        pair = new_pair(group);
+    } else {
+        pair = idle.back();
+        idle.pop_back();
+    }
+    ++replayed_;
+
+    auto const packets = [] (int bytes) {
+        return std::max(1, (bytes + PACKET_SIZE - 1) / PACKET_SIZE);
+    };
+    auto const app = groups_[group].pairs[pair].chunks;
+    if (flow.num_chunks == 0 || app == nullptr) {
+        auto const bytes = packets(flow.size_bytes) * PACKET_SIZE;
+        if (begin_flow(group, pair, bytes)) {
+            groups_[group].pairs[pair].apps->send(bytes);
+        }
+        return;
+    }
+
+    auto& chunks = replay_chunks_;
+    chunks.clear();
+    auto bytes = 0;
+    for (int i = 0; i < flow.num_chunks; ++i) {
+        auto const chunk = trace_->chunk(i);
+        auto const size = packets(chunk.size_bytes) * PACKET_SIZE;
+        chunks.push_back(ChunksApplication::Chunk{chunk.offset, size});
+        bytes += size;
+    }
+    if (begin_flow(group, pair, bytes)) {
+        app->send_chunks(chunks);
+    }
+}
+
+/*
+ * Agent_Aggr_pair check_if_behind: the next arrival is due but every
+ * pair is still busy, so Tcl has to build another one.
+ */
+void TrafficMatrix::check_if_behind(int group) {
+    auto const now = Scheduler::instance().clock();
+    auto const& grp = groups_[group];
+
+    if (flow_gen_ < flow_limit_ && grp.tnext < now + 0.0000002) {
+        schedule(group, new_pair(group));
+    }
+}
+
+/*
+ * TCP_pair fin_notify followed by Agent_Aggr_pair fin_notify.
+ */
+void TrafficMatrix::flow_finished(FlowEndpoint& sender) {
+    auto const [group, pair] = senders_.at(&sender);
+    auto& p = groups_[group].pairs[pair];
+
+    auto const fldur = Scheduler::instance().clock() - p.start_time;
+    if (fldur == 0) {
+        Tcl::instance().eval("puts \"dt = 0\"; flush stdout");
+    }
+
+    auto const old_rttimes = p.rttimes;
+    p.rttimes = sender.retransmit_timeouts();
+    log_flow(groups_[group], pair, fldur, p.rttimes - old_rttimes, sender);
+
+    ++flow_fin_;
+    if (flow_fin_ >= flow_limit_) {
+        end_run();
+    } else if (convergence_ != nullptr && convergence_->converged()) {
+        Tcl::instance().evalf("puts \"Converged after %d flows\"; flush stdout",
+                flow_fin_);
+        end_run();
+    }
+    if (pool_ || trace_) {
+        groups_[group].idle.push_back(pair);
+    } else if (flow_gen_ < flow_limit_) {
+        schedule(group, pair);
+    }
+}
+
+void TrafficMatrix::log_flow(Group const& group, int pair, double fldur,
+        int rttimes, FlowEndpoint const& sender) {
+    auto const& p = group.pairs[pair];
+    auto const oracle = oracle_fct(group, p);
+
+    if (binlog_) {
+        binlog_->append(p.bytes / PACKET_SIZE, fldur, rttimes,
+                group.src, group.dst, pair, sender.flow_deadline(),
+                sender.flow_early_terminated(), oracle);
+    }
+    if (fldur > 0) {    // result.py skips zero FCTs too
+        auto const flow = FctStats::Flow{fldur, oracle, p.bytes, rttimes,
+                sender.flow_deadline(), sender.flow_early_terminated() != 0};
+        if (stats_) {
+            stats_->add(flow);
+        }
+        // the flows start_flow counts in flow_gen_
+        if (convergence_ != nullptr && p.start_time >= count_after_) {
+            convergence_->add(flow);
+        }
+    }
+    if (logfile_ == nullptr) {
+        return;
+    }
+
+    auto const line = tcl_double(p.bytes / double(PACKET_SIZE))
+        + " " + tcl_double(fldur)
+        + " " + std::to_string(rttimes)
+        + " " + group.group_id
+        + " " + std::to_string(pair)
+        + " " + std::to_string(sender.flow_deadline())
+        + " " + std::to_string(sender.flow_early_terminated())
+        + " " + tcl_double(oracle)
+        + "\n";
+    Tcl_Write(logfile_, line.c_str(), static_cast<int>(line.size()));
+    Tcl_Flush(logfile_);
+}
+
+auto TrafficMatrix::oracle_fct(Group const& group, Pair const& pair) const -> double {
+    if (pair.chunks != nullptr) {
+        return pair.chunks->ideal_transfer_time() + group.path_rtt;
+    }
+    auto const packet_time = (PACKET_SIZE + HEADER_SIZE) * 8 / (link_rate_ * 1e9);
+    return pair.bytes / PACKET_SIZE * packet_time + group.path_rtt;
+}
+
+/*
+ * Tcl finish exits, so everything buffered is written out first.
+ */
+void TrafficMatrix::end_run() {
+    if (binlog_) {
+        binlog_->flush();
+    }
+    write_summary(true);
+    Tcl::instance().eval("finish");
+}
+
+void TrafficMatrix::write_summary(bool complete) {
+    if (!stats_) {
+        return;
+    }
+    try {
+        stats_->write(summary_path_, Scheduler::instance().clock(), complete);
+    } catch (std::runtime_error const& e) {
+        fprintf(stderr, "TrafficMatrix: %s\n", e.what());
+    }
+}
@@ -0,0 +1,160 @@
+#ifndef ns_traffic_matrix_h
+#define ns_traffic_matrix_h
+
+#include <tools/ArrivalTrace.h>
+#include <tools/ColumnarLog.h>
+#include <tools/CommandDispatchHelper.h>
+#include <tools/FctStats.h>
+#include <tools/FlowEndpoint.h>
+#include <common/scheduler.h>
+#include <apps/app-chunks.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Application;
+class ConvergenceController;
+class RandomVariable;
+
+/*
+ * Native flow arrival process for the Agent_Aggr_pair groups of
+ * tcp-common-opt.tcl.
+ *
+ * Each group (one per src/dst host pair) keeps the next arrival time
+ * drawn from its inter-arrival variable, and every idle TCP pair of the
+ * group claims the next arrival, exactly like Agent_Aggr_pair
+ * schedule/fin_notify, but with the flow start, the
+ * completion callback and the log line handled here instead of going
+ * through Tcl for every flow.  Agents report completion through
+ * FlowEndpoint; only the rare "not enough pairs" case calls back into
+ * Tcl (add-native-pair) to create a connection.
+ *
+ * With pool_ set, pairs no longer claim arrivals themselves: the group
+ * runs a single arrival chain and every arrival takes the most recently
+ * released idle pair from a free list, creating a pair only when the
+ * list is empty.  Connections are persistent, so an idle pair needs no
+ * reset before reuse, and the number of pairs is bounded by the peak
+ * number of concurrent flows of the group.  Arrival times and sizes are
+ * the same as without the pool; only the pair serving a flow differs.
+ *
+ * Every log line ends with the oracle FCT of the flow: its transfer time
+ * at link_rate_ (for Application/Chunks, following the chunk release
+ * schedule it actually used) plus the round-trip propagation delay of
+ * the routed path between the two hosts, given to add-group.
+ *
+ * attach-binlog additionally writes the same fields to a ColumnarLog.
+ *
+ * attach-summary feeds every flow to an FctStats and writes its summary
+ * when the run finishes and, if summary_interval_ is set, every that
+ * many simulated seconds before; add-summary-bucket adds a size bucket
+ * to the fixed ones.
+ *
+ * replay takes the flows from an ArrivalTrace instead of the groups'
+ * random variables: a flow of the trace starts, at its time after the
+ * first start-group, on an idle pair of the group of its src and dst
+ * hosts (created as with pool_), and Application/Chunks pairs release
+ * it as the chunks recorded for it, if any.  Sizes are rounded up to
+ * whole packets.  The run finishes once every replayed flow finished
+ * if the trace ends before flow_limit_.
+ *
+ * attach-convergence ends the run before flow_limit_ as soon as the
+ * ConvergenceController, fed every flow that counts towards flow_limit_,
+ * reports that its metrics converged.
+ *
+ * flow_limit_ is sim_end: no flow starts once that many flows arrived
+ * after count_after_, and Tcl finish is invoked once that many finished.
+ */
+class TrafficMatrix : public TclObject, public FlowObserver, public Handler {
+    using super = TclObject;
+public:
+    TrafficMatrix();
+
+    auto command(int argc, char const * const * argv) -> int override;
+    void flow_finished(FlowEndpoint& sender) override;
+    void handle(Event* event) override;
+
+private:
+    struct Pair {
+        FlowEndpoint* tcps;
+        FlowEndpoint* tcpr;
+        Application* apps;
+        ChunksApplication* chunks;  // apps, if it is an Application/Chunks
+        double start_time;
+        int bytes;
+        int rttimes;
+    };
+
+    struct Group {
+        std::string aggr;       // Agent_Aggr_pair, asked for new pairs
+        std::string group_id;
+        int src;                // group_id is "src dst" for the binary log
+        int dst;
+        RandomVariable* flow_intval;
+        RandomVariable* nbytes;
+        double path_rtt;
+        double tnext;
+        std::vector<Pair> pairs;
+        std::vector<int> idle;  // free list of pair ids, pool_ only
+    };
+
+    class ArrivalEvent;
+
+private:
+    auto attach_logfile(std::string_view channel_name) -> nfp::command::TclResult;
+    auto attach_binlog(std::string_view directory) -> nfp::command::TclResult;
+    auto attach_summary(std::string_view path) -> nfp::command::TclResult;
+    auto add_summary_bucket(std::string_view name, std::string_view lower,
+            std::string_view upper) -> nfp::command::TclResult;
+    auto attach_convergence(std::string_view controller) -> nfp::command::TclResult;
+    auto replay(std::string_view path) -> nfp::command::TclResult;
+    auto add_group(std::string_view aggr, std::string_view group_id,
+            std::string_view flow_intval, std::string_view nbytes,
+            std::string_view path_rtt) -> nfp::command::TclResult;
+    auto add_pair(std::string_view group, std::string_view tcps,
+            std::string_view tcpr, std::string_view apps) -> nfp::command::TclResult;
+    auto start_group(std::string_view group) -> nfp::command::TclResult;
+
+    void schedule(int group, int pair);
+    void schedule_arrival(int group);
+    void pool_arrival(int group, int bytes);
+    auto new_pair(int group) -> int;
+    void start_flow(int group, int pair, int bytes);
+    auto begin_flow(int group, int pair, int bytes) -> bool;
+    void schedule_replay();
+    void replay_arrivals();
+    void replay_flow(ArrivalTrace::Flow const& flow);
+    void check_if_behind(int group);
+    void log_flow(Group const& group, int pair, double fldur, int rttimes,
+            FlowEndpoint const& sender);
+    auto oracle_fct(Group const& group, Pair const& pair) const -> double;
+    void write_summary(bool complete);
+    void end_run();
+
+private:
+    int flow_limit_;
+    double count_after_;
+    double link_rate_;      // Gbps
+    int pool_;
+    double summary_interval_;
+    int flow_gen_;
+    int flow_fin_;
+    Tcl_Channel logfile_;
+    std::unique_ptr<ColumnarLog> binlog_;
+    std::unique_ptr<FctStats> stats_;
+    std::string summary_path_;
+    ConvergenceController* convergence_;
+    std::unique_ptr<ArrivalTrace> trace_;
+    // reused between flows, so a replay allocates only for its longest flow
+    std::vector<ChunksApplication::Chunk> replay_chunks_;
+    double replay_start_;   // < 0 until the first start-group
+    int replayed_;
+    std::map<std::pair<int, int>, int> host_groups_;   // replay: (src, dst) -> group
+    std::vector<Group> groups_;
+    std::unordered_map<FlowEndpoint const*, std::pair<int, int>> senders_;
+};
+
+#endif
@@ -44,6 +44,9 @@ static const char rcsid[] =
     "@(#) $Header: /cvsroot/nsnam/ns-2/tools/ranvar.cc,v 1.25 2011/05/16 03:49:09 tom_henderson Exp $ (Xerox)";
 
 #include <stdio.h>
+#include <algorithm>
+#include <map>
+#include <stdexcept>
 #include "ranvar.h"
 
 RandomVariable::RandomVariable()
@@ -468,7 +471,67 @@ public:
 	}
 } class_empiricalranvar;
 
-EmpiricalRandomVariable::EmpiricalRandomVariable() : minCDF_(0), maxCDF_(1), maxEntry_(32), table_(0)
+auto EmpiricalCDF::load(std::string const& filename) -> std::shared_ptr<EmpiricalCDF const>
+{
+	static std::map<std::string, std::shared_ptr<EmpiricalCDF const>> cache;
+
+	auto& cdf = cache[filename];
+	if (cdf)
+		return cdf;
+
+	FILE* fp = fopen(filename.c_str(), "r");
+	if (fp == 0)
+		throw std::runtime_error("cannot open CDF file " + filename);
+
+	std::vector<CDFentry> table;
+	char line[256];
+	while (fgets(line, 256, fp)) {
+		CDFentry e;
+		// Use * and l together raises a warning
+		if (sscanf(line, "%lf %*f %lf", &e.val_, &e.cdf_) == 2)
+			table.push_back(e);
+	}
+	fclose(fp);
+
+	if (table.empty())
+		throw std::runtime_error("empty CDF file " + filename);
+	cdf = std::make_shared<EmpiricalCDF const>(std::move(table));
+	return cdf;
+}
+
+EmpiricalCDF::EmpiricalCDF(std::vector<CDFentry> table)
+	: table_(std::move(table)), guide_(table_.size()), guide_width_(0)
+{
+	double const lo = table_.front().cdf_;
+	guide_width_ = (table_.back().cdf_ - lo) / guide_.size();
+
+	int i = 0;
+	for (int k = 0; k < static_cast<int>(guide_.size()); k++) {
+		while (i < size() - 1 && table_[i].cdf_ < lo + k * guide_width_)
+			i++;
+		guide_[k] = i;
+	}
+}
+
+int EmpiricalCDF::lookup(double u) const
+{
+	// always return an index whose value is >= u
+	if (u <= table_.front().cdf_)
+		return 0;
+	if (u > table_.back().cdf_ || guide_width_ <= 0)
+		return size() - 1;
+
+	int k = static_cast<int>((u - table_.front().cdf_) / guide_width_);
+	int i = guide_[std::min(k, static_cast<int>(guide_.size()) - 1)];
+	// the slice edge may be off by rounding, so search both ways
+	while (i > 0 && table_[i-1].cdf_ >= u)
+		i--;
+	while (i < size() - 1 && table_[i].cdf_ < u)
+		i++;
+	return i;
+}
+
+EmpiricalRandomVariable::EmpiricalRandomVariable() : minCDF_(0), maxCDF_(1), maxEntry_(32)
 {
 	bind("minCDF_", &minCDF_);
 	bind("maxCDF_", &maxCDF_);
@@ -492,46 +555,31 @@ int EmpiricalRandomVariable::command(int argc, const char*const* argv)
 	return RandomVariable::command(argc, argv);
 }
 
+/*
+ * Tables are shared between all instances loading the same file, so
+ * the ~20k size variables of a large run parse their CDF once.
+ */
 int EmpiricalRandomVariable::loadCDF(const char* filename)
 {
-	FILE* fp;
-	char line[256];
-	CDFentry* e;
-
-	fp = fopen(filename, "r");
-	if (fp == 0) 
+	try {
+		table_ = EmpiricalCDF::load(filename);
+	} catch (std::runtime_error const&) {
 		return 0;
-
-
-	if (table_ == 0)
-		table_ = new CDFentry[maxEntry_];
-	for (numEntry_=0;  fgets(line, 256, fp);  numEntry_++) {
-		if (numEntry_ >= maxEntry_) {	// resize the CDF table
-			maxEntry_ *= 2;
-			e = new CDFentry[maxEntry_];
-			for (int i=numEntry_-1; i >= 0; i--)
-				e[i] = table_[i];
-			delete table_;
-			table_ = e;
-		}
-		e = &table_[numEntry_];
-		// Use * and l together raises a warning
-		sscanf(line, "%lf %*f %lf", &e->val_, &e->cdf_);
 	}
-        fclose(fp);
-	return numEntry_;
+	return table_->size();
 }
 
 double EmpiricalRandomVariable::value()
 {
-	if (numEntry_ <= 0)
+	if (!table_)
 		return 0;
+	EmpiricalCDF const& table = *table_;
 	double u = rng_->uniform(minCDF_, maxCDF_);
-	int mid = lookup(u);
-	if (mid && interpolation_ && u < table_[mid].cdf_)
-		return interpolate(u, table_[mid-1].cdf_, table_[mid-1].val_,
-				   table_[mid].cdf_, table_[mid].val_);
-	return table_[mid].val_;
+	int mid = table.lookup(u);
+	if (mid && interpolation_ && u < table[mid].cdf_)
+		return interpolate(u, table[mid-1].cdf_, table[mid-1].val_,
+				   table[mid].cdf_, table[mid].val_);
+	return table[mid].val_;
 }
 
 double EmpiricalRandomVariable::interpolate(double x, double x1, double y1, double x2, double y2)
@@ -541,19 +589,3 @@ double EmpiricalRandomVariable::interpolate(double x, double x1, double y1, doub
 		return ceil(value);
 	return value;
 }
-
-int EmpiricalRandomVariable::lookup(double u)
-{
-	// always return an index whose value is >= u
-	int lo, hi, mid;
-	if (u <= table_[0].cdf_)
-		return 0;
-	for (lo=1, hi=numEntry_-1;  lo < hi; ) {
-		mid = (lo + hi) / 2;
-		if (u > table_[mid].cdf_)
-			lo = mid + 1;
-		else
-			hi = mid;
-	}
-	return lo;
-}
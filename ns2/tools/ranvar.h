@@ -52,6 +52,10 @@
 #include "random.h"
 #include "rng.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 class RandomVariable : public TclObject {
  public:
 	virtual double value() = 0;
@@ -237,6 +241,37 @@ struct CDFentry {
 	double val_;
 };
 
+/*
+ * A CDF file parsed once per process and shared read-only by every
+ * RandomVariable/Empirical that loads it.
+ *
+ * lookup() returns the first entry whose cdf_ is >= u (the last one if
+ * there is none), like the binary search it replaces, but starts from a
+ * guide table (Chen & Asau): guide_[k] is the answer for the left edge
+ * of the k-th of size() equal slices of [cdf_ of the first entry, cdf_
+ * of the last], so a lookup only steps over the entries inside its
+ * slice, O(1) on average.
+ */
+class EmpiricalCDF {
+public:
+	/*
+	 * Returns the table for `filename`, parsing it on first use.
+	 * Throws std::runtime_error if the file has no entry.
+	 */
+	static auto load(std::string const& filename) -> std::shared_ptr<EmpiricalCDF const>;
+
+	explicit EmpiricalCDF(std::vector<CDFentry> table);
+
+	[[nodiscard]] auto lookup(double u) const -> int;
+	[[nodiscard]] auto operator[](int i) const -> CDFentry const& { return table_[i]; }
+	[[nodiscard]] auto size() const -> int { return static_cast<int>(table_.size()); }
+
+private:
+	std::vector<CDFentry> const table_;
+	std::vector<int> guide_;
+	double guide_width_;
+};
+
 class EmpiricalRandomVariable : public RandomVariable {
 public:
 	virtual double value();
@@ -249,14 +284,12 @@ public:
 
 protected:
 	int command(int argc, const char*const* argv);
-	int lookup(double u);
 
 	double minCDF_;		// min value of the CDF (default to 0)
 	double maxCDF_;		// max value of the CDF (default to 1)
 	int interpolation_;	// how to interpolate data (INTER_DISCRETE...)
-	int numEntry_;		// number of entries in the CDF table
-	int maxEntry_;		// size of the CDF table (mem allocation)
-	CDFentry* table_;	// CDF table of (val_, cdf_)
+	int maxEntry_;		// unused, kept for scripts that set it
+	std::shared_ptr<EmpiricalCDF const> table_;	// CDF table of (val_, cdf_)
 };
 
 #endif
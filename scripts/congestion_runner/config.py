@@ -21,6 +21,7 @@ class PriorityScheme(Enum):
     BYTES_SENT = 3
     LAZY_REMAINING_SIZE = 6
     LAZY_REMAINING_SIZE_BYTES_SENT = 7
+    GITTINS = 8
 
 
 class DelayAssignmentConfig:
@@ -2,6 +2,7 @@ import subprocess
 import json
 import os
 import sys
+import time
 from itertools import product
 from os import path
 from shutil import which
@@ -15,6 +16,8 @@ from congestion_runner.config import Aspect, Config, Run
 SCRIPT_LOCATION = path.dirname(path.abspath(__file__))
 DELAY_ASSIGNMENT_JSON_FNAME = 'delay_assignment.json'
 PACKET_PROPERTIES_ASSIGNMENT_JSON_FNAME = 'packet_properties_assignment.json'
+# written once a simulation succeeded, with its wall time and peak RSS
+DONE_FNAME = 'done.json'
 
 
 class Options:
@@ -41,6 +44,7 @@ def run_it(
     delay_assignment_json: Optional[dict],
     packet_properties_assignment_json: Optional[dict],
     opt: Options,
+    cpu: Optional[int] = None,
 ) -> RunResult:
 
     # Make directory to save results
@@ -72,24 +76,49 @@ def run_it(
         debug_args = ['--call-graph', 'dwarf'] if opt.debug else []
         exe_args = ['perf', 'record'] + debug_args + exe_args
 
+    if cpu is not None:
+        # not preexec_fn, which may deadlock under sweep.py's threads
+        exe_args = ['taskset', '-c', str(cpu)] + exe_args
+
+    done_path = path.join(directory_name, DONE_FNAME)
+    if path.exists(done_path):
+        os.remove(done_path)
+
+    start = time.monotonic()
     with open(path.join(directory_name, 'stdout.log'), 'w') as stdout:
         with open(path.join(directory_name, 'stderr.log'), 'w') as stderr:
-            process = subprocess.run(
+            process = subprocess.Popen(
                     exe_args + args, stdout=stdout, stderr=stderr)
+            # wait4 instead of wait for the resource usage of the child
+            _, status, rusage = os.wait4(process.pid, 0)
+            process.returncode = os.waitstatus_to_exitcode(status)
+    wall_time = time.monotonic() - start
 
     if process.returncode != 0:
         with open(path.join(directory_name, 'stdout.log')) as stdout:
             with open(path.join(directory_name, 'stderr.log')) as stderr:
                 return (process.returncode, stdout.read(), stderr.read())
 
+    with open(done_path, 'w') as done_file:
+        json.dump({'wall_time': wall_time,
+                   'user_time': rusage.ru_utime,
+                   'max_rss_kb': rusage.ru_maxrss,
+                   'cpu': cpu}, done_file)
+
     return (0, None, None)
 
 
+def is_complete(directory_name: str) -> bool:
+    """Whether the simulation of directory_name ran to the end."""
+    return path.isfile(path.join(directory_name, DONE_FNAME))
+
+
 def run_single_config(
         run: Run,
         ns_path: str,
         results_dir: str,
-        opt: Options) -> RunResult:
+        opt: Options,
+        cpu: Optional[int] = None) -> RunResult:
     config = Config.from_file('config.toml', run)
 
     directory_name = path.join(results_dir, config.run_name)
@@ -170,6 +199,18 @@ def run_single_config(
         config['rtx_on_eof'],
         config['reset_window_on_eof'],
         config['afabric_ecn_enable'],
+        config.plot_generation_bounds,
+        config['convergence_precision'],
+        path.abspath(config['arrival_trace'])
+        if 'arrival_trace' in config else None,
+        config['flowlet_gap'],
+        config['congestion_aware_mp'],
+        config['path_telemetry_interval'],
+        config['link_failures'],
+        config['link_failure_time'],
+        config['link_failure_duration'],
+        config['reconverge_delay'],
+        config['pool_pairs'],
     ]
 
     args = [_to_tcl_arg(arg) for arg in args]
@@ -180,7 +221,8 @@ def run_single_config(
         path.abspath(directory_name),
         config.delay_assignment_json,
         config.packet_properties_assignment_json,
-        opt)
+        opt,
+        cpu)
 
 
 def _to_tcl_arg(arg: Any) -> str:
@@ -0,0 +1,95 @@
+import os
+import queue
+import sys
+from concurrent.futures import ThreadPoolExecutor, as_completed
+from os import path
+from typing import List, Optional
+
+import click
+
+from congestion_runner.config import Config, Run
+from congestion_runner.run import (Options, RunResult, _get_ns_path,
+                                   config_params, is_complete,
+                                   run_single_config)
+
+
+def _available_memory_gb() -> float:
+    with open('/proc/meminfo') as meminfo:
+        for line in meminfo:
+            if line.startswith('MemAvailable:'):
+                return int(line.split()[1]) / (1024 * 1024)
+    raise RuntimeError('MemAvailable missing from /proc/meminfo')
+
+
+def _num_jobs(jobs: Optional[int], cpus: List[int],
+              mem_per_run: Optional[float]) -> int:
+    """At most one simulation per allowed core and, with mem_per_run,
+    as many as fit into the memory available now."""
+    num = min(jobs or len(cpus), len(cpus))
+    if mem_per_run is not None:
+        num = min(num, int(_available_memory_gb() // mem_per_run))
+    return max(num, 1)
+
+
+@click.command()
+@click.option('--dry-run', is_flag=True)
+@click.option('--debug', is_flag=True)
+@click.option('--ns-executable', type=click.Path())
+@click.option('--results-dir', type=click.Path(), default='results')
+@click.option('--jobs', type=int,
+              help='simulations at once (default: one per core)')
+@click.option('--mem-per-run', type=float,
+              help='GiB one simulation needs, to bound --jobs by memory')
+@click.option('--force', is_flag=True,
+              help='rerun configurations that already completed')
+@config_params(multi=True)
+def sweep(debug: bool,
+          runs: List[Run],
+          dry_run: bool,
+          ns_executable: str,
+          results_dir: str,
+          jobs: Optional[int],
+          mem_per_run: Optional[float],
+          force: bool):
+    """Runs every combination of the given aspects in parallel, each
+    simulation pinned to its own core."""
+    ns_path = _get_ns_path(debug, ns_executable)
+    opt = Options(dry_run=dry_run, valgrind=False, perf=False, debug=debug)
+
+    pending = [run for run in runs if force or not is_complete(path.join(
+        results_dir, Config.from_file('config.toml', run).run_name))]
+    print(f'{len(runs) - len(pending)} of {len(runs)} runs already complete')
+
+    cpus = sorted(os.sched_getaffinity(0))
+    num_jobs = _num_jobs(jobs, cpus, mem_per_run)
+    free_cpus: queue.Queue = queue.Queue()
+    for cpu in cpus[:num_jobs]:
+        free_cpus.put(cpu)
+
+    def run_pinned(run: Run) -> RunResult:
+        cpu = free_cpus.get()
+        try:
+            return run_single_config(run, ns_path, results_dir, opt, cpu)
+        finally:
+            free_cpus.put(cpu)
+
+    failed = 0
+    # the simulations are child processes, threads only wait for them
+    with ThreadPoolExecutor(max_workers=num_jobs) as executor:
+        futures = {executor.submit(run_pinned, run): run for run in pending}
+        for future in as_completed(futures):
+            name = Config.from_file('config.toml', futures[future]).run_name
+            returncode, _, serr = future.result()
+            if returncode != 0:
+                failed += 1
+                sys.stderr.write(f'{name} failed ({returncode}):\n{serr}\n')
+            else:
+                print(f'{name} done')
+
+    if failed > 0:
+        sys.stderr.write(f'{failed} of {len(pending)} runs failed\n')
+        exit(1)
+
+
+if __name__ == '__main__':
+    sweep()
@@ -0,0 +1,58 @@
+"""Writer for the flow arrival traces replayed by ns2/tools/ArrivalTrace.
+
+Converts a text trace, one flow per line:
+
+    time src dst size_bytes [offset:size_bytes ...]
+
+with the optional chunk release schedule of the flow (offsets relative
+to its start), into the binary format; times are relative to the start
+of the replay.  src and dst are host indices as in spine_empirical.tcl.
+"""
+
+import struct
+from typing import Iterable, List, Optional, Tuple
+
+import click
+
+MAGIC = b'AFTRACE1'
+_FLOW = struct.Struct('<diiii')
+_CHUNK = struct.Struct('<dii')
+
+Chunk = Tuple[float, int]
+Flow = Tuple[float, int, int, int, Optional[List[Chunk]]]
+
+
+def write_trace(filename: str, flows: Iterable[Flow]):
+    """Writes (time, src, dst, size_bytes, chunks or None) flows, which
+    must come in order of time."""
+    last_time = float('-inf')
+    with open(filename, 'wb') as trace:
+        trace.write(MAGIC)
+        for time, src, dst, size, chunks in flows:
+            if time < last_time:
+                raise ValueError(f'flow at {time} after one at {last_time}')
+            last_time = time
+
+            chunks = chunks or []
+            trace.write(_FLOW.pack(time, src, dst, size, len(chunks)))
+            for offset, chunk_size in chunks:
+                trace.write(_CHUNK.pack(offset, chunk_size, 0))
+
+
+def _parse_line(line: str) -> Flow:
+    time, src, dst, size, *chunks = line.split()
+    return (float(time), int(src), int(dst), int(size),
+            [(float(offset), int(chunk_size))
+             for offset, chunk_size in (c.split(':') for c in chunks)])
+
+
+@click.command()
+@click.argument('text_trace', type=click.File('r'))
+@click.argument('output', type=click.Path())
+def convert(text_trace, output: str):
+    write_trace(output, (_parse_line(line) for line in text_trace
+                         if line.strip() and not line.startswith('#')))
+
+
+if __name__ == '__main__':
+    convert()
@@ -1,10 +1,11 @@
+#include "chunk-schedule.h"
+
 #include <ios>
 #include <string>
 #include <algorithm>
 #include <iostream>
 #include <map>
 #include <random>
-#include <limits>
 
 namespace {
 
@@ -18,59 +19,29 @@ struct simulation_params {
     double link_delay;
     double host_delay;
     int max_num_chunks;
+    ChunkSchedule<std::minstd_rand0>::Mode mode;
 };
 
-struct Chunk { 
-    double time;
-    int size_in_bytes; 
-
-    auto operator<(Chunk const& other) {
-        return std::make_tuple(time, size_in_bytes) 
-            < std::make_tuple(other.time, other.size_in_bytes);
-    };
-};
-
-auto generate_next_random_double(double min, double max, std::minstd_rand0& rng) {
-    auto const x = std::generate_canonical<
-        double, std::numeric_limits<double>::digits>(rng);
-    return min + x * (max - min);
-}
-
 auto get_packet_time(simulation_params const& params) {
     return (PACKET_SIZE + HEADER_SIZE) * BITS_IN_BYTE / params.rate;
 }
 
-auto generate_chunks(simulation_params const& params, 
-                     int num_bytes, std::minstd_rand0& rng) {
+auto get_oracle_fct(simulation_params const& params, int src, int dst,
+                    int num_bytes, std::minstd_rand0& rng) {
     auto const num_packets = num_bytes / PACKET_SIZE;
-    auto const num_chunks = std::min(num_packets, params.max_num_chunks);
-    auto const chunk_size_pkts = num_packets / num_chunks;
-    auto const num_bigger_chunks = num_packets % num_chunks;
-
     auto const start_time = 0.0;
     auto const end_time = start_time + params.alpha * get_packet_time(params) * num_packets;
-    auto chunks = std::vector<Chunk>(num_chunks);
-    for (auto i = 0; i < num_chunks; i++) {
-        chunks[i] = Chunk { 
-            .time = generate_next_random_double(start_time, end_time, rng),
-            .size_in_bytes = PACKET_SIZE * 
-                (i < num_bigger_chunks ? chunk_size_pkts + 1 : chunk_size_pkts)
-        };
-    }
-    std::sort(begin(chunks), end(chunks));
-    return chunks;
-}
 
-auto get_oracle_fct(simulation_params const& params, int src, int dst, 
-                    std::vector<Chunk> const& chunks) {
-    auto end_time = 0.0; 
-    for (auto &[start_time, num_bytes] : chunks) {
-        end_time = std::max(start_time, end_time) + 
-            num_bytes / PACKET_SIZE * get_packet_time(params);
+    auto schedule = ChunkSchedule<std::minstd_rand0>{};
+    schedule.reset(params.mode, rng, start_time, end_time,
+                   num_packets, params.max_num_chunks, PACKET_SIZE,
+                   get_packet_time(params));
+    while (!schedule.done()) {
+        schedule.next();
     }
     auto const num_hops = src / 16 == dst / 16 ? 2 : 4;
     auto const propagation_delay = 2 * (num_hops * params.link_delay + 2 * params.host_delay);
-    return end_time + propagation_delay;
+    return schedule.ideal_finish_time() + propagation_delay;
 }
 
 }
@@ -83,6 +54,10 @@ int main(int argc, char const * argv[]) {
         .link_delay = std::stod(argv[3]),
         .host_delay = std::stod(argv[4]),
         .max_num_chunks = std::stoi(argv[5]),
+        // must match Application/Chunks streaming_schedule_
+        .mode = argc > 6 && argv[6] == std::string("streaming")
+            ? ChunkSchedule<std::minstd_rand0>::Mode::STREAMING
+            : ChunkSchedule<std::minstd_rand0>::Mode::LEGACY,
     };
 
     auto rngs = std::map<std::tuple<int, int, int>, std::minstd_rand0>{};
@@ -103,8 +78,7 @@ int main(int argc, char const * argv[]) {
             rngs[key] = std::minstd_rand0(seed);
         }
 
-        auto const chunks = generate_chunks(params, size_in_bytes, rngs[key]);
-        auto const oracle_fct = get_oracle_fct(params, src, dst, chunks);
+        auto const oracle_fct = get_oracle_fct(params, src, dst, size_in_bytes, rngs[key]);
         std::cout << oracle_fct << "\n";
     }
 }
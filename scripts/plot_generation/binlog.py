@@ -0,0 +1,30 @@
+"""Reader for the binary logs written by ns2/tools/ColumnarLog.
+
+A log is a directory with schema.json and one raw column file
+<name>.bin per column; every column is memory-mapped, nothing is parsed.
+"""
+
+import json
+from os import path
+from typing import Dict
+
+import numpy as np
+
+
+def read(directory: str) -> Dict[str, np.ndarray]:
+    """Maps column name to a read-only array of its values."""
+    with open(path.join(directory, 'schema.json')) as fp:
+        schema = json.load(fp)
+
+    columns = {}
+    for column in schema['columns']:
+        file = path.join(directory, column['name'] + '.bin')
+        dtype = np.dtype(column['dtype'])
+        rows = path.getsize(file) // dtype.itemsize
+        columns[column['name']] = (
+            np.memmap(file, dtype=dtype, mode='r', shape=(rows,))
+            if rows > 0 else np.empty(0, dtype=dtype))
+
+    # a run that died mid-row leaves some columns one value longer
+    rows = min((len(c) for c in columns.values()), default=0)
+    return {name: values[:rows] for name, values in columns.items()}
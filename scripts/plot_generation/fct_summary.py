@@ -0,0 +1,148 @@
+"""Reader for the FCT summaries written by ns2/tools/FctStats.
+
+A summary holds, per flow size bucket, the sums and counts behind the
+result.py statistics and a log-linear histogram per percentile metric,
+so summaries of several runs merge exactly (up to the histogram
+resolution) without the per-flow logs.
+"""
+
+import json
+import math
+from collections import Counter
+from typing import Dict, List, Optional
+
+_SUMS = ['num', 'num_no_deadline', 'deadlines', 'deadlines_met', 'timeouts',
+         'fct_sum', 'nfct_sum', 'real_nfct_sum', 'gp_sum', 'nd_gp_sum']
+_SKETCHES = ['fct', 'nfct', 'real_nfct']
+
+
+def load(file: str) -> dict:
+    with open(file) as fp:
+        return json.load(fp)
+
+
+def merge(summaries: List[dict]) -> dict:
+    """Combines summaries with the same buckets, e.g. of several seeds."""
+    first = summaries[0]
+    buckets = {b['name']: {'name': b['name'], 'lower': b['lower'],
+                           'upper': b['upper'],
+                           'state': {**{s: 0 for s in _SUMS},
+                                     **{s: Counter() for s in _SKETCHES}}}
+               for b in first['buckets']}
+
+    for summary in summaries:
+        if summary['precision'] != first['precision']:
+            raise ValueError('summaries with different precisions')
+        for b in summary['buckets']:
+            merged = buckets.get(b['name'])
+            if merged is None or (merged['lower'], merged['upper']) \
+                    != (b['lower'], b['upper']):
+                raise ValueError(f"bucket {b['name']} does not match")
+            for s in _SUMS:
+                merged['state'][s] += b['state'][s]
+            for s in _SKETCHES:
+                merged['state'][s].update(dict(b['state'][s]))
+
+    for merged in buckets.values():
+        for s in _SKETCHES:
+            merged['state'][s] = sorted(merged['state'][s].items())
+
+    return {'time': max(s['time'] for s in summaries),
+            'complete': all(s['complete'] for s in summaries),
+            'precision': first['precision'],
+            'buckets': list(buckets.values())}
+
+
+def _percentile(sketch, precision: int, percent: int) -> float:
+    """QuantileSketch::percentile."""
+    num = sum(count for _, count in sketch)
+    if num == 0:
+        return 0
+    rank = percent * num // 100
+    seen = 0
+    for key, count in sketch:
+        seen += count
+        if seen > rank:
+            break
+    sub = key & ((1 << precision) - 1)
+    return math.ldexp(0.5 + math.ldexp(sub + 0.5, -(precision + 1)),
+                      key >> precision)
+
+
+class SummaryStats:
+    """The FlowSetStats properties used by result.py report, for one
+    bucket of a summary."""
+
+    def __init__(self, summary: dict, name: str,
+                 lower: Optional[int] = None, upper: Optional[int] = None,
+                 check_bounds: bool = False):
+        buckets: Dict[str, dict] = {b['name']: b for b in summary['buckets']}
+        if name not in buckets:
+            raise ValueError(f'no bucket {name} in the summary')
+        bucket = buckets[name]
+        if check_bounds and (bucket['lower'], bucket['upper']) \
+                != (lower, upper):
+            raise ValueError(f'bucket {name} has other bounds')
+
+        self.name = name
+        self._state = bucket['state']
+        self._precision = summary['precision']
+
+    def _average(self, total: str, num: str, empty: float) -> float:
+        n = self._state[num]
+        return self._state[total] / n if n > 0 else empty
+
+    def _percentile(self, sketch: str, percent: int) -> float:
+        return _percentile(self._state[sketch], self._precision, percent)
+
+    @property
+    def num_flows(self) -> int:
+        return self._state['num']
+
+    @property
+    def num_timeouts(self) -> int:
+        return self._state['timeouts']
+
+    @property
+    def deadlines(self) -> int:
+        return self._state['deadlines']
+
+    @property
+    def deadlines_met(self) -> int:
+        return self._state['deadlines_met']
+
+    @property
+    def avg_gp(self) -> float:
+        return self._average('gp_sum', 'num', 0)
+
+    @property
+    def avg_nondeadline_gp(self) -> float:
+        return self._average('nd_gp_sum', 'num_no_deadline', 0)
+
+    @property
+    def avg_fct(self) -> float:
+        return self._average('fct_sum', 'num', float('inf'))
+
+    @property
+    def avg_nfct(self) -> float:
+        return self._average('nfct_sum', 'num', float('inf'))
+
+    @property
+    def avg_real_nfct(self) -> float:
+        return self._average('real_nfct_sum', 'num', float('inf'))
+
+    @property
+    def fct_99th(self) -> float:
+        return self._percentile('fct', 99)
+
+    @property
+    def median_fct(self) -> float:
+        return self._percentile('fct', 50)
+
+    @property
+    def nfct_99th(self) -> float:
+        return self._percentile('nfct', 99)
+
+    @property
+    def real_nfct_99th(self) -> float:
+        return self._percentile('real_nfct', 99)
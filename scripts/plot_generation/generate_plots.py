@@ -85,20 +85,38 @@ def save_result(aspect: Aspect, run: Run, run_results: List[RunResult]):
             writer.writerow(row_dict)
 
 
+def _logs_oracle_fct(flow_path: str) -> bool:
+    """Whether the simulator already wrote the oracle FCT column."""
+    with open(flow_path) as flow_file:
+        for line in flow_file:
+            if len(line.split()) >= 3:
+                return len(line.split()) >= 9
+    return False
+
+
 async def _get_all_results(directory_name: str, config: Config) -> dict:
+    summary_path = path.join(directory_name, 'flow.summary.json')
     flow_path = path.join(directory_name, 'flow.tr')
     ofct_path = path.join(directory_name, 'ofct.tr')
 
-    with open(flow_path) as flow_file, open(ofct_path, 'w') as ofct_file:
-        args = [str(config.alpha), str(config.link_rate_bps),
-                str(config['mean_link_delay']), str(config['host_delay']),
-                str(config['max_num_chunks'])]
-        process = await asyncio.create_subprocess_exec(
-                    APPEND_TRUE_FCT, *args, stdin=flow_file, stdout=ofct_file)
-        await process.wait()
-
-    args = [RESULT_PY,
-            '--input', flow_path, '--ofct-input', ofct_path,
+    if path.isfile(summary_path):
+        input_args = ['--summary', summary_path]
+    elif path.isdir(path.join(directory_name, 'flow.bin')):
+        input_args = ['--input', path.join(directory_name, 'flow.bin')]
+    elif not _logs_oracle_fct(flow_path):
+        with open(flow_path) as flow_file, open(ofct_path, 'w') as ofct_file:
+            args = [str(config.alpha), str(config.link_rate_bps),
+                    str(config['mean_link_delay']), str(config['host_delay']),
+                    str(config['max_num_chunks'])]
+            process = await asyncio.create_subprocess_exec(
+                        APPEND_TRUE_FCT, *args, stdin=flow_file,
+                        stdout=ofct_file)
+            await process.wait()
+        input_args = ['--input', flow_path, '--ofct-input', ofct_path]
+    else:
+        input_args = ['--input', flow_path]
+
+    args = [RESULT_PY, *input_args,
             '--overall', '--small', '--median', '--large',
             '--avg', '--avgn', '--avgrealn', '--tail',
             '--thd', '--json', '--gp', '--to',
@@ -0,0 +1,74 @@
+"""Summaries of the multipath telemetry written by ns2/tools/MultiPathTelemetry.
+
+The uplink series (<flow log>.uplinks) has a row per node, uplink and
+sample interval; the path log (<flow log>.paths) a row whenever a flow
+shows on an uplink within an interval.  Both are ColumnarLogs, read with
+binlog.py.
+"""
+
+import argparse
+from typing import Dict, List, Tuple
+
+import numpy as np
+
+import binlog
+
+
+def imbalance(series: Dict[str, np.ndarray]) -> Dict[int, np.ndarray]:
+    """Per node, the max / mean bytes over its uplinks in each interval
+    with traffic (1 is perfectly balanced)."""
+    result = {}
+    for node in np.unique(series['node']):
+        rows = series['node'] == node
+        times = series['time'][rows]
+        num_uplinks = len(np.unique(series['next_hop'][rows]))
+        if num_uplinks < 2:
+            continue
+        _, interval = np.unique(times, return_inverse=True)
+        sums = np.bincount(interval, weights=series['bytes'][rows])
+        maxima = np.zeros(len(sums))
+        np.maximum.at(maxima, interval, series['bytes'][rows])
+        busy = sums > 0
+        result[int(node)] = maxima[busy] / (sums[busy] / num_uplinks)
+    return result
+
+
+def flow_paths(paths: Dict[str, np.ndarray]) \
+        -> Dict[Tuple[int, int, int], List[Tuple[int, int]]]:
+    """(src, dst, fid) -> the distinct (node, next_hop) hops the flow
+    took, in order of first use."""
+    result = {}
+    for src, dst, fid, node, next_hop in zip(
+            paths['src'], paths['dst'], paths['fid'], paths['node'],
+            paths['next_hop']):
+        hops = result.setdefault((int(src), int(dst), int(fid)), [])
+        if (int(node), int(next_hop)) not in hops:
+            hops.append((int(node), int(next_hop)))
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='ECMP imbalance per node from a multipath telemetry '
+                    'series, and optionally how many flows changed path')
+    parser.add_argument('series', help='uplink series directory')
+    parser.add_argument('--paths', help='flow path log directory')
+    args = parser.parse_args()
+
+    print('node intervals mean_imbalance p99_imbalance max_imbalance')
+    for node, ratios in sorted(imbalance(binlog.read(args.series)).items()):
+        if len(ratios) == 0:
+            continue
+        print(node, len(ratios), np.mean(ratios), np.percentile(ratios, 99),
+              np.max(ratios))
+
+    if args.paths:
+        paths = flow_paths(binlog.read(args.paths))
+        # a flow uses one uplink per multipath node unless it was moved
+        moved = sum(1 for hops in paths.values()
+                    if len(hops) > len({node for node, _ in hops}))
+        print(f'flows {len(paths)} moved {moved}')
+
+
+if __name__ == '__main__':
+    main()
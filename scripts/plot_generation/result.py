@@ -1,7 +1,11 @@
 import argparse
+from contextlib import nullcontext
 from json import dumps
+from os import path
 from typing import List, Optional
 
+import fct_summary
+
 _PACKET_SIZE = 1460
 _HDR_SIZE = 40
 _BITS_IN_BYTE = 8
@@ -133,15 +137,14 @@ class FlowSetStats:
             return 0
 
 
-def _parse_line(line: str, ofct_line: str):
+def _parse_line(line: str, ofct_line: Optional[str]):
     pkt_size, time, timeouts_num, src, dst, pid, deadline, *rest = line.split()
-    oracle_fct, = ofct_line.split()
 
-    early_termination_str = None
-    try:
-        early_termination_str, = rest
-    except ValueError:
-        pass
+    early_termination_str = rest[0] if len(rest) > 0 else None
+    # TrafficMatrix logs the oracle FCT itself, older logs need --ofct-input
+    oracle_fct = rest[1] if len(rest) > 1 else None
+    if ofct_line is not None:
+        oracle_fct, = ofct_line.split()
 
     early_termination = int(early_termination_str) == 1\
         if early_termination_str is not None else False
@@ -151,6 +154,44 @@ def _parse_line(line: str, ofct_line: str):
             float(deadline) * 1.e-6, early_termination, float(oracle_fct))
 
 
+def _read_text_flows(input_path: str, ofct_input: Optional[str]):
+    with open(input_path) as fp, \
+            (open(ofct_input) if ofct_input else nullcontext()) as ofct_fp:
+        while True:
+            line = fp.readline()
+            ofct_line = ofct_fp.readline() if ofct_fp else None
+
+            if not line:
+                break
+            if len(line.split()) < 3:
+                continue
+
+            pkt_size, time, num_to, src, dst, _, deadline, early, ofct \
+                = _parse_line(line, ofct_line)
+            yield pkt_size, time, num_to, src, dst, deadline, early, ofct
+
+
+def _read_binlog_flows(directory: str):
+    import binlog  # needs numpy, which text logs don't
+    columns = binlog.read(directory)
+    return zip(columns['size_pkts'].astype(float).tolist(),
+               columns['fct'].tolist(),
+               columns['timeouts'].tolist(),
+               columns['src'].tolist(),
+               columns['dst'].tolist(),
+               (columns['deadline_us'] * 1.e-6).tolist(),
+               (columns['early_terminated'] == 1).tolist(),
+               columns['oracle_fct'].tolist())
+
+
+def _read_flows(input_path: str, ofct_input: Optional[str]):
+    """(pkts, fct, timeouts, src, dst, deadline, early, oracle fct) tuples
+    from a text flow log or a binary one (see binlog.py)."""
+    if path.isdir(input_path):
+        return _read_binlog_flows(input_path)
+    return _read_text_flows(input_path, ofct_input)
+
+
 def _has_deadline(deadline, early_termination):
     return deadline != 0.0 or early_termination
 
@@ -223,8 +264,14 @@ def report(report_avg, report_tail, report_num_deadlines, report_gp,
 
 
 parser = argparse.ArgumentParser()
-parser.add_argument("--input", help="input file name")
-parser.add_argument("--ofct-input", help="ofct input file name")
+parser.add_argument("--input",
+                    help="input file name, or binary log directory")
+parser.add_argument("--ofct-input",
+                    help="ofct input file name, if the flow log has no"
+                         " oracle FCT column")
+parser.add_argument("--summary", action="append",
+                    help="FCT summary to report instead of a flow log,"
+                         " repeat to merge several runs")
 parser.add_argument("--rate", help="link rate")
 parser.add_argument("--link-delay", help="link propagation delay")
 parser.add_argument("--host-delay", help="host delay")
@@ -297,34 +344,36 @@ flowsets = [overall, short, median, large] + custom_sets
 
 
 if args.input:
-    with open(args.input) as fp, open(args.ofct_input) as ofct_fp:
-        while True:
-            line = fp.readline()
-            ofct_line = ofct_fp.readline()
-
-            if not line:
-                break
-            if len(line.split()) < 3:
-                continue
-
-            pkt_size, time, num_to, src, dst, _, deadline, early, ofct \
-                = _parse_line(line, ofct_line)
-            byte_size = pkt_size * 1460
-
-            if time == 0:
-                continue
-
-            for flow_set in flowsets:
-                flow_set.add(
-                    src,
-                    dst,
-                    ofct,
-                    time,
-                    byte_size,
-                    _is_deadline_met(deadline, time, early),
-                    _has_deadline(deadline, early),
-                    num_to)
-
+    for pkt_size, time, num_to, src, dst, deadline, early, ofct \
+            in _read_flows(args.input, args.ofct_input):
+        byte_size = pkt_size * 1460
+
+        if time == 0:
+            continue
+
+        for flow_set in flowsets:
+            flow_set.add(
+                src,
+                dst,
+                ofct,
+                time,
+                byte_size,
+                _is_deadline_met(deadline, time, early),
+                _has_deadline(deadline, early),
+                num_to)
+
+if args.summary:
+    summary = fct_summary.merge([fct_summary.load(f) for f in args.summary])
+    overall, short, median, large = (
+        fct_summary.SummaryStats(summary, flow_set.name)
+        for flow_set in (overall, short, median, large))
+    custom_sets = [
+        fct_summary.SummaryStats(summary, flow_set.name,
+                                 flow_set.bound.lower, flow_set.bound.upper,
+                                 check_bounds=True)
+        for flow_set in custom_sets]
+
+if args.input or args.summary:
     json: Optional[dict] = {} if args.json else None
 
     if args.all:
@@ -1,5 +1,7 @@
 source [file join [file dirname [info script]] "tcp-common-opt.tcl"]
 
+# hand same-time arrivals (e.g. incast ACKs) to classifiers and queues together
+Scheduler set batch_ 64
 set ns [new Simulator]
 puts "Date: [clock seconds]"
 set sim_start [clock seconds]
@@ -72,8 +74,15 @@ set topology_spines [next_arg]
 set topology_x [next_arg]
 
 ### result file
-set flowlog [open [next_arg] w]
-set droplog [open [next_arg] w]
+set flowlog_path [next_arg]
+set flowlog [open $flowlog_path w]
+set droplog_path [next_arg]
+set droplog [open $droplog_path w]
+# binary copies of both logs, see scripts/plot_generation/binlog.py
+set flow_binlog "[file rootname $flowlog_path].bin"
+set drop_binlog "[file rootname $droplog_path].bin"
+# FCT statistics without the per-flow log, see plot_generation/fct_summary.py
+set flow_summary "[file rootname $flowlog_path].summary.json"
 
 set delay_assigner_filename [next_arg]
 set use_fifo_processing_order [next_arg]
@@ -87,6 +96,26 @@ set use_true_remaining_size [next_arg]
 set rtx_on_eof [next_arg]
 set reset_window_on_eof [next_arg]
 set enable_afabric_ecn [next_arg]
+# extra flow size buckets "lower,upper" of the summary, as result.py --bound
+set summary_bounds [next_arg]
+# stop once the FCT metrics are this precise, 0 to always run all flows
+set convergence_precision [next_arg]
+# binary arrival trace to replay instead of the random arrivals, if any
+set arrival_trace [next_arg]
+# multipath flowlet gap in seconds, 0 for none
+set flowlet_gap [next_arg]
+# multipath by egress queue occupancy (per flowlet, or per packet)
+set congestionAwareMP [next_arg]
+# sample interval of the uplink counters and flow paths, 0 for none
+set path_telemetry_interval [next_arg]
+# number of ToR-spine links to fail, at which time and for how long (0:
+# for good), and how long until the routes follow (< 0: never)
+set link_failures [next_arg]
+set link_failure_time [next_arg]
+set link_failure_duration [next_arg]
+set reconverge_delay [next_arg]
+# serve each host pair's arrivals from a pool of idle connections
+set pool_pairs [next_arg]
 
 if {$next_arg_idx < $argc} {
     puts "[expr $argc - $next_arg_idx] unconsumed arguments"
@@ -181,6 +210,43 @@ if {[string compare $sourceAlg "DCTCP-Sack"] == 0} {
     Agent/TCPSink set ecnhat_ true
     Agent/TCP set ecnhat_g_ $DCTCP_g
     Agent/TCP set lldct_ false
+} elseif {[string compare $sourceAlg "HPCC-Sack"] == 0} {
+    set myAgent "Agent/TCP/FullTcp/Sack$tcpSuffix"
+    Agent/TCP set ecnhat_ false
+    Agent/TCP set lldct_ false
+    Agent/TCP/FullTcp set hpcc_enabled_ true
+    # host-ToR-spine-ToR-host and back, without serialisation
+    Agent/TCP/FullTcp set hpcc_base_rtt_ [expr 4 * ($host_delay + 2 * $mean_link_delay)]
+    Queue set int_enabled_ true
+} elseif {[string compare $sourceAlg "Swift-Sack"] == 0} {
+    set myAgent "Agent/TCP/FullTcp/Sack$tcpSuffix"
+    Agent/TCP set ecnhat_ false
+    Agent/TCP set lldct_ false
+    Agent/TCP/FullTcp set swift_enabled_ true
+    # base RTT plus one packet of queueing per link
+    set swift_pkt_time [expr ($pktSize + 40) * 8.0 / ($link_rate * 1e9)]
+    Agent/TCP/FullTcp set swift_base_target_ [expr 4 * ($host_delay + 2 * $mean_link_delay)]
+    Agent/TCP/FullTcp set swift_per_hop_ $swift_pkt_time
+    Agent/TCP/FullTcp set swift_fs_range_ [expr 4 * $swift_pkt_time]
+    Agent/TCP/FullTcp set swift_fs_max_cwnd_ $initWindow
+} elseif {[string compare $sourceAlg "Homa"] == 0} {
+    set myAgent "Agent/Homa"
+    Agent/Homa set packetSize_ $pktSize
+    # the initial window is sized to one BDP, and so is the unscheduled part
+    Agent/Homa set rtt_bytes_ [expr $initWindow * $pktSize]
+    Agent/Homa set rtx_timeout_ $min_rto
+    if {[string compare $switchAlg "Priority"] == 0 && $prio_num_ > 1} {
+        Agent/Homa set sched_prio_num_ [expr $prio_num_ - 1]
+    }
+} elseif {[string compare $sourceAlg "NDP"] == 0} {
+    set myAgent "Agent/NDP"
+    Agent/NDP set packetSize_ $pktSize
+    Agent/NDP set rtt_bytes_ [expr $initWindow * $pktSize]
+    Agent/NDP set rtx_timeout_ $min_rto
+    Agent/NDP set link_rate_ $link_rate
+    # NDP relies on the switches cutting payloads instead of dropping
+    Queue/DropTail set trim_ true
+    Queue/Priority set trim_ true
 }
 
 if {$chunks_alpha != {}} {
@@ -204,6 +270,16 @@ $myAgent set enable_early_expiration_ $enable_early_expiration
 
 #Shuang
 Agent/TCP/FullTcp set prio_scheme_ $prio_scheme_;
+
+# GITTINS ranks flows by the size CDF the arrivals are drawn from
+set gittins_cdf {}
+if {$prio_scheme_ == 8} {
+    if {[lindex $nbytes_rv_cmd 0] != "create_empirical_rv"} {
+        puts "the GITTINS priority scheme needs an empirical flow size CDF"
+        exit 1
+    }
+    set gittins_cdf [lindex $nbytes_rv_cmd 1]
+}
 if {$enable_dupack} {
     Agent/TCP/FullTcp set dynamic_dupack_ 0;
 } else {
@@ -291,15 +367,20 @@ Queue/Priority set marking_scheme_ $ECN_scheme_
 
 ############## Multipathing ###########################
 if {$enableMultiPath == 1} {
-    $ns rtproto DV
-    Agent/rtProto/DV set advertInterval	[expr 2*$sim_end]
-    Node set multiPath_ 1
+    $ns rtproto StaticECMP
     if {$perflowMP != 0} {
         Classifier/MultiPath set perflow_ 1
         Agent/TCP/FullTcp set dynamic_dupack_ 0; # enable duplicate ACK
     }
+    Classifier/MultiPath set flowlet_gap_ $flowlet_gap
+    Classifier/MultiPath set congestion_aware_ $congestionAwareMP
+    # backup next hops, if the topology has any
+    RouteLogic set lfa_ [expr $link_failures > 0]
 }
 
+# no traces or monitors on the fabric links: skip their head connector
+SimpleLink set fast_ 1
+
 ############# Topoplgy #########################
 set S [expr $topology_spt * $topology_tors] ; #number of servers
 set UCap [expr $link_rate * $topology_spt / $topology_spines / $topology_x] ; #uplink rate
@@ -333,12 +414,62 @@ for {set i 0} {$i < $topology_tors} {incr i} {
     }
 }
 
+############ Link failures ##############
+# ToR i to spine k / tors, spreading over the ToRs first
+for {set k 0} {$k < $link_failures} {incr k} {
+    if {$k >= $topology_tors * $topology_spines} {
+        puts "link_failures $link_failures > number of core links"
+        exit 1
+    }
+    set recover_at ""
+    if {$link_failure_duration > 0} {
+        set recover_at [expr $link_failure_time + $link_failure_duration]
+    }
+    $ns fail-link $n([expr $k % $topology_tors])\
+        $a([expr $k / $topology_tors]) $link_failure_time $recover_at\
+        $reconverge_delay
+}
+
 #############  Agents ################
 puts "Setting up connections ..."; flush stdout
 
 set flow_gen 0
 set flow_fin 0
 
+set traffic_matrix [new TrafficMatrix]
+$traffic_matrix set flow_limit_ $sim_end
+$traffic_matrix set link_rate_ $link_rate
+$traffic_matrix set pool_ $pool_pairs
+$traffic_matrix attach-logfile $flowlog
+$traffic_matrix attach-binlog $flow_binlog
+$traffic_matrix attach-summary $flow_summary
+if {$arrival_trace != ""} {
+    $traffic_matrix replay $arrival_trace
+}
+if {$path_telemetry_interval > 0} {
+    # see scripts/plot_generation/path_telemetry.py
+    set mp_telemetry [new MultiPathTelemetry]
+    $mp_telemetry set interval_ $path_telemetry_interval
+    $mp_telemetry start "[file rootname $flowlog_path].uplinks"\
+        "[file rootname $flowlog_path].paths"
+}
+if {$convergence_precision > 0} {
+    set convergence [new ConvergenceController]
+    $convergence set precision_ $convergence_precision
+    # mean and tail real nFCT of the short, median and large flows of result.py
+    foreach {lower upper} {"" 102400 102401 10485760 10485760 ""} {
+        $convergence add-metric $lower $upper realnfct mean
+        $convergence add-metric $lower $upper realnfct p99
+    }
+    $traffic_matrix attach-convergence $convergence
+}
+set i 0
+foreach bound $summary_bounds {
+    lassign [split $bound ,] lower upper
+    $traffic_matrix add-summary-bucket custom$i $lower $upper
+    incr i
+}
+
 set init_fid 0
 for {set j 0} {$j < $S } {incr j} {
     for {set i 0} {$i < $S } {incr i} {
@@ -346,6 +477,7 @@ for {set j 0} {$j < $S } {incr j} {
                 set agtagr($i,$j) [new Agent_Aggr_pair]
                 $agtagr($i,$j) setup $s($i) $s($j) "$i $j" $connections_per_pair $init_fid "TCP_pair"
                 $agtagr($i,$j) attach-logfile $flowlog
+                $agtagr($i,$j) attach-traffic-matrix $traffic_matrix
 
                 puts  "($i,$j) :  [expr 17*$i+1244*$j] [expr 33*$i+4369*$j]"
 
@@ -1,5 +1,7 @@
 source "tcp-common-opt.tcl"
 
+# hand same-time arrivals (e.g. incast ACKs) to classifiers and queues together
+Scheduler set batch_ 64
 set ns [new Simulator]
 puts "Date: [clock format [clock seconds]]"
 set sim_start [clock seconds]
@@ -129,6 +131,9 @@ if {[string compare $sourceAlg "DCTCP-Sack"] == 0} {
 
 #Shuang
 Agent/TCP/FullTcp set prio_scheme_ $prio_scheme_;
+# GITTINS ranks the flows of each pair by the CDF they are drawn from,
+# set per pair below (TCP_pair setup reads it)
+set gittins_cdf {}
 Agent/TCP/FullTcp set dynamic_dupack_ 1000000; #disable dupack
 Agent/TCP set window_ 1000000
 Agent/TCP set windowInit_ $initWindow
@@ -198,15 +203,16 @@ Queue/Priority set marking_scheme_ $ECN_scheme_
 
 ############## Multipathing ###########################
 if {$enableMultiPath == 1} {
-    $ns rtproto DV
-	Agent/rtProto/DV set advertInterval	[expr 2*$sim_end]
-	Node set multiPath_ 1
+    $ns rtproto StaticECMP
     if {$perflowMP != 0} {
         Classifier/MultiPath set perflow_ 1
         Agent/TCP/FullTcp set dynamic_dupack_ 0; # enable duplicate ACK
     }
 }
 
+# no traces or monitors on the fabric links: skip their head connector
+SimpleLink set fast_ 1
+
 ############# Topoplgy #########################
 set S [expr $topology_spt * $topology_tors] ; #number of servers
 set UCap [expr $link_rate * $topology_spt / $topology_spines / $topology_x] ; #uplink rate
@@ -256,6 +262,9 @@ set init_fid 0
 for {set j 0} {$j < $S } {incr j} {
     for {set i 0} {$i < $S } {incr i} {
         if {$i != $j} {
+                if {$prio_scheme_ == 8} {
+                    set gittins_cdf [expr {$i < $j ? $flow_cdf_1 : $flow_cdf_2}]
+                }
                 set agtagr($i,$j) [new Agent_Aggr_pair]
                 $agtagr($i,$j) setup $s($i) $s($j) "$i $j" $connections_per_pair $init_fid "TCP_pair"
                 $agtagr($i,$j) attach-logfile $flowlog
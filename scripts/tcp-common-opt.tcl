@@ -87,7 +87,7 @@ TCP_pair instproc init_delay { } {
 TCP_pair instproc setup {snode dnode} {
 #Directly connect agents to snode, dnode.
 #For faster simulation.
-    global ns delay_assigner_filename
+    global ns delay_assigner_filename gittins_cdf
     $self instvar apps tcps tcpr;# Sender TCP,  Receiver TCP
     $self instvar san dan  ;# memorize dumbell node (to attach)
 
@@ -99,6 +99,10 @@ TCP_pair instproc setup {snode dnode} {
         $tcpr set-delay-assigner "$delay_assigner_filename"
     }
 
+    if {[info exists gittins_cdf] && $gittins_cdf != {}} {
+        $tcps set-gittins-cdf $gittins_cdf
+    }
+
     $self init_delay
 
     $ns attach-agent $snode $tcps;
@@ -274,6 +278,30 @@ Agent/TCP/FullTcp instproc done_data {} {
     }
 }
 
+Agent/Homa instproc set_callback {tcp_pair} {
+    $self instvar ctrl
+    $self set ctrl $tcp_pair
+}
+
+Agent/Homa instproc done_data {} {
+    $self instvar ctrl
+    if { [info exists ctrl] } {
+        $ctrl fin_notify
+    }
+}
+
+Agent/NDP instproc set_callback {tcp_pair} {
+    $self instvar ctrl
+    $self set ctrl $tcp_pair
+}
+
+Agent/NDP instproc done_data {} {
+    $self instvar ctrl
+    if { [info exists ctrl] } {
+        $ctrl fin_notify
+    }
+}
+
 Class Agent_Aggr_pair
 #Note:
 #Contoller and placeholder of Agent_pairs
@@ -312,6 +340,7 @@ Class Agent_Aggr_pair
 #set_PEarrival_process {lambda mean_nbytes rands1 rands2}        <-
 #set_PBarrival_process {lambda mean_nbytes S1 S2 rands1 rands2}  <- of them
 #init_schedule {}       <- must
+#attach-traffic-matrix {tm} <- optional, schedule flows natively
 
 #fin_notify { pid bytes fldur bps } ;# Callback
 #start_notify {}                   ;# Callback
@@ -392,6 +421,10 @@ Agent_Aggr_pair instproc init_schedule {} {
     global ns
     $self instvar nr_pairs apair
 
+    if { [$self native_schedule] } {
+        return
+    }
+
     # Mohammad: initializing last_arrival_time
     #$self instvar last_arrival_time
     #$self set last_arrival_time [$ns now]
@@ -413,6 +446,49 @@ Agent_Aggr_pair instproc init_schedule {} {
 }
 
 
+Agent_Aggr_pair instproc attach-traffic-matrix { tm } {
+#Public
+#Let the TrafficMatrix $tm run the arrival process natively
+#instead of init_schedule/schedule/fin_notify.
+    $self instvar traffic_matrix
+    $self set traffic_matrix $tm
+}
+
+Agent_Aggr_pair instproc native_schedule {} {
+#Private
+#Hand the group to the TrafficMatrix, if one is attached
+    $self instvar traffic_matrix tm_group
+    $self instvar nr_pairs apair group_id rv_flow_intval rv_nbytes
+
+    if { ![info exists traffic_matrix] } {
+        return 0
+    }
+
+    $self instvar s_node d_node
+    set path_rtt [expr [path_delay $s_node $d_node] + [path_delay $d_node $s_node]]
+    $self set tm_group [$traffic_matrix add-group $self $group_id $rv_flow_intval $rv_nbytes $path_rtt]
+    for {set i 0} {$i < $nr_pairs} {incr i} {
+        $traffic_matrix add-pair $tm_group [$apair($i) set tcps] [$apair($i) set tcpr] [$apair($i) set apps]
+    }
+    $traffic_matrix start-group $tm_group
+    return 1
+}
+
+proc path_delay {snode dnode} {
+#Propagation delay of the routed path from snode to dnode.
+#Routes exist only once the simulator runs.
+    global ns
+    set routelogic [$ns get-routelogic]
+    set delay 0
+    set node $snode
+    while {$node != $dnode} {
+        set next [$ns get-node-by-id [$routelogic lookup [$node id] [$dnode id]]]
+        set delay [expr $delay + [[$ns link $node $next] delay]]
+        set node $next
+    }
+    return $delay
+}
+
 Agent_Aggr_pair instproc set_PParrival_process {lambda mean_nbytes shape rands1 rands2} {
 #Public
 #setup random variable rv_flow_intval and rv_nbytes.
@@ -637,31 +713,54 @@ Agent_Aggr_pair instproc check_if_behind {} {
     set t [$ns now]
     # The test for $tnext can only pass if $tnext has not changed
     if { $flow_gen < $sim_end && $tnext < [expr $t + 0.0000002] } { #create new flow
-        puts "[$ns now]: creating new connection $nr_pairs $s_node -> $d_node"
-        flush stdout
-        $self set apair($nr_pairs) [new $apair_type]
-
-        if {[string compare $myApp "Application/Chunks"] == 0} {
-            set app_seed [expr 17 * [lindex 0 $group_id] + 1244 * [lindex 1 $group_id] + $nr_pairs]
-            [$apair($nr_pairs) set apps] set-seed $app_seed
-        }
-
-        $apair($nr_pairs) setup $s_node $d_node
-        $apair($nr_pairs) setgid $group_id
-        $apair($nr_pairs) setpairid $nr_pairs
-        $apair($nr_pairs) setfid $init_fid
-        incr init_fid
+        set pid [$self create_pair]
 
         #### Callback Setting #################
-        $apair($nr_pairs) set_fincallback $self fin_notify
-        $apair($nr_pairs) set_startcallback $self start_notify
+        $apair($pid) set_fincallback $self fin_notify
+        $apair($pid) set_startcallback $self start_notify
         #######################################
-        $self schedule $nr_pairs
-        incr nr_pairs
+        $self schedule $pid
     }
 
 }
 
+Agent_Aggr_pair instproc create_pair {} {
+#Private
+#Add one more pair to the group, returns its pair id
+    global ns myApp init_fid
+    $self instvar apair
+    $self instvar nr_pairs
+    $self instvar apair_type s_node d_node group_id
+
+    puts "[$ns now]: creating new connection $nr_pairs $s_node -> $d_node"
+    flush stdout
+    $self set apair($nr_pairs) [new $apair_type]
+
+    if {[string compare $myApp "Application/Chunks"] == 0} {
+        set app_seed [expr 17 * [lindex 0 $group_id] + 1244 * [lindex 1 $group_id] + $nr_pairs]
+        [$apair($nr_pairs) set apps] set-seed $app_seed
+    }
+
+    $apair($nr_pairs) setup $s_node $d_node
+    $apair($nr_pairs) setgid $group_id
+    $apair($nr_pairs) setpairid $nr_pairs
+    $apair($nr_pairs) setfid $init_fid
+    incr init_fid
+
+    set pid $nr_pairs
+    incr nr_pairs
+    return $pid
+}
+
+Agent_Aggr_pair instproc add-native-pair {} {
+#Callback Function
+#Called by the TrafficMatrix when every pair of the group is busy
+    $self instvar apair traffic_matrix tm_group
+
+    set pid [$self create_pair]
+    $traffic_matrix add-pair $tm_group [$apair($pid) set tcps] [$apair($pid) set tcpr] [$apair($pid) set apps]
+}
+
 
 Agent_Aggr_pair instproc fin_notify { pid bytes fldur bps rttimes deadline early_terminated } {
 #Callback Function
@@ -719,12 +818,18 @@ Agent_Aggr_pair instproc start_notify {} {
 }
 
 proc finish {} {
-    global ns flowlog droplog drop_sink
+    global ns flowlog droplog drop_sink drop_binlog mp_telemetry
     global sim_start
     global enableNAM namfile
 
     $drop_sink print-stats $droplog
+    if {[info exists drop_binlog]} {
+        $drop_sink write-binlog $drop_binlog
+    }
     close $droplog
+    if {[info exists mp_telemetry]} {
+        $mp_telemetry stop
+    }
     $ns flush-trace
     close $flowlog
 